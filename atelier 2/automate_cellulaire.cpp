@@ -1,53 +1,211 @@
 #include "automate_cellulaire.h"
+#include <atomic>
 #include <iostream>
 #include <vector>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CA_X86 1
+#endif
+
 using namespace std;
 
+namespace {
+
+// Évolution de 256 cellules (4 mots) pendant plusieurs générations
+typedef void (*Kernel256)(uint64_t* words, const uint64_t* rule_mask, size_t generations);
+
+#ifdef CA_X86
+
+// Le mot k du registre est le mot k de l'état. Voisin gauche : décalage d'un
+// bit vers la droite, complété par le bit de poids faible du mot précédent ;
+// voisin droit : symétrique avec le mot suivant. Hors de l'état : 0.
+__attribute__((target("avx2")))
+void evolve256_avx2(uint64_t* words, const uint64_t* rule_mask, size_t generations) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i m[8];
+    for (int i = 0; i < 8; i++) {
+        m[i] = _mm256_set1_epi64x(static_cast<long long>(rule_mask[i]));
+    }
+    // Différences utilisées par les multiplexeurs (voir apply_rule_word)
+    const __m256i d1 = _mm256_xor_si256(m[1], m[0]);
+    const __m256i d3 = _mm256_xor_si256(m[3], m[2]);
+    const __m256i d5 = _mm256_xor_si256(m[5], m[4]);
+    const __m256i d7 = _mm256_xor_si256(m[7], m[6]);
+
+    __m256i state = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words));
+    for (size_t g = 0; g < generations; g++) {
+        // Mots précédents [0, w0, w1, w2] et suivants [w1, w2, w3, 0]
+        __m256i previous = _mm256_blend_epi32(_mm256_permute4x64_epi64(state, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03);
+        __m256i next = _mm256_blend_epi32(_mm256_permute4x64_epi64(state, _MM_SHUFFLE(3, 3, 2, 1)), zero, 0xC0);
+        __m256i left = _mm256_or_si256(_mm256_srli_epi64(state, 1), _mm256_slli_epi64(previous, 63));
+        __m256i right = _mm256_or_si256(_mm256_slli_epi64(state, 1), _mm256_srli_epi64(next, 63));
+
+        __m256i x00 = _mm256_xor_si256(m[0], _mm256_and_si256(right, d1));
+        __m256i x01 = _mm256_xor_si256(m[2], _mm256_and_si256(right, d3));
+        __m256i x10 = _mm256_xor_si256(m[4], _mm256_and_si256(right, d5));
+        __m256i x11 = _mm256_xor_si256(m[6], _mm256_and_si256(right, d7));
+        __m256i y0 = _mm256_xor_si256(x00, _mm256_and_si256(state, _mm256_xor_si256(x01, x00)));
+        __m256i y1 = _mm256_xor_si256(x10, _mm256_and_si256(state, _mm256_xor_si256(x11, x10)));
+        state = _mm256_xor_si256(y0, _mm256_and_si256(left, _mm256_xor_si256(y1, y0)));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(words), state);
+}
+
+// vpternlogq avec l'immédiat 0xCA calcule s ? a : b bit à bit : chaque
+// multiplexeur du calcul AVX2 tient en une instruction, et la règle reste une
+// donnée (masques diffusés) au lieu d'un immédiat propre à chaque règle.
+__attribute__((target("avx512f,avx512vl")))
+void evolve256_avx512(uint64_t* words, const uint64_t* rule_mask, size_t generations) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i m[8];
+    for (int i = 0; i < 8; i++) {
+        m[i] = _mm256_set1_epi64x(static_cast<long long>(rule_mask[i]));
+    }
+
+    __m256i state = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words));
+    for (size_t g = 0; g < generations; g++) {
+        __m256i previous = _mm256_alignr_epi64(state, zero, 3);  // [0, w0, w1, w2]
+        __m256i next = _mm256_alignr_epi64(zero, state, 1);      // [w1, w2, w3, 0]
+        __m256i left = _mm256_or_si256(_mm256_srli_epi64(state, 1), _mm256_slli_epi64(previous, 63));
+        __m256i right = _mm256_or_si256(_mm256_slli_epi64(state, 1), _mm256_srli_epi64(next, 63));
+
+        __m256i x00 = _mm256_ternarylogic_epi64(right, m[1], m[0], 0xCA);
+        __m256i x01 = _mm256_ternarylogic_epi64(right, m[3], m[2], 0xCA);
+        __m256i x10 = _mm256_ternarylogic_epi64(right, m[5], m[4], 0xCA);
+        __m256i x11 = _mm256_ternarylogic_epi64(right, m[7], m[6], 0xCA);
+        __m256i y0 = _mm256_ternarylogic_epi64(state, x01, x00, 0xCA);
+        __m256i y1 = _mm256_ternarylogic_epi64(state, x11, x10, 0xCA);
+        state = _mm256_ternarylogic_epi64(left, y1, y0, 0xCA);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(words), state);
+}
+
+#endif // CA_X86
+
+bool cpuSupports(CellularAutomaton::Backend backend) {
+    switch (backend) {
+    case CellularAutomaton::SCALAR:
+        return true;
+#ifdef CA_X86
+    case CellularAutomaton::AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    case CellularAutomaton::AVX512:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl");
+#endif
+    default:
+        return false;
+    }
+}
+
+CellularAutomaton::Backend detectBackend() {
+    if (cpuSupports(CellularAutomaton::AVX512)) return CellularAutomaton::AVX512;
+    if (cpuSupports(CellularAutomaton::AVX2)) return CellularAutomaton::AVX2;
+    return CellularAutomaton::SCALAR;
+}
+
+std::atomic<int>& currentBackend() {
+    static std::atomic<int> backend(detectBackend());
+    return backend;
+}
+
+// Noyau vectoriel d'une implémentation (nul pour le calcul mot par mot)
+Kernel256 kernelFor(CellularAutomaton::Backend backend) {
+    switch (backend) {
+#ifdef CA_X86
+    case CellularAutomaton::AVX512: return evolve256_avx512;
+    case CellularAutomaton::AVX2: return evolve256_avx2;
+#endif
+    default: return nullptr;
+    }
+}
+
+} // namespace
+
 void CellularAutomaton::init_rule(int rule_num) {
     rule_number = rule_num;
     for (int i = 0; i < 8; i++) {
         rule[i] = (rule_num >> i) & 1;
+        rule_mask[i] = rule[i] ? ~0ULL : 0;
     }
 }
 
-int CellularAutomaton::apply_rule(int left, int center, int right) {
-    int index = (left << 2) | (center << 1) | right;
-    return rule[index];
+// La table de la règle devient un multiplexeur à trois niveaux : le voisin droit
+// choisit entre deux entrées de la table, puis la cellule, puis le voisin gauche
+// (mux(s, a, b) = b ^ (s & (a ^ b)) donne a là où s vaut 1, b ailleurs)
+uint64_t CellularAutomaton::apply_rule_word(uint64_t left, uint64_t center, uint64_t right) const {
+    uint64_t x00 = rule_mask[0] ^ (right & (rule_mask[1] ^ rule_mask[0]));
+    uint64_t x01 = rule_mask[2] ^ (right & (rule_mask[3] ^ rule_mask[2]));
+    uint64_t x10 = rule_mask[4] ^ (right & (rule_mask[5] ^ rule_mask[4]));
+    uint64_t x11 = rule_mask[6] ^ (right & (rule_mask[7] ^ rule_mask[6]));
+    uint64_t y0 = x00 ^ (center & (x01 ^ x00));
+    uint64_t y1 = x10 ^ (center & (x11 ^ x10));
+    return y0 ^ (left & (y1 ^ y0));
 }
 
-CellularAutomaton::CellularAutomaton(int rule_num) {
+CellularAutomaton::CellularAutomaton(int rule_num) : cell_count(0), last_mask(0) {
     init_rule(rule_num);
 }
 
 void CellularAutomaton::init_state(const vector<int>& initial_state) {
-    state = initial_state;
+    cell_count = initial_state.size();
+    words.assign((cell_count + 63) / 64, 0);
+    for (size_t i = 0; i < cell_count; i++) {
+        if (initial_state[i]) {
+            words[i / 64] |= 1ULL << (63 - i % 64);
+        }
+    }
+    size_t used = cell_count % 64;
+    last_mask = used ? ~0ULL << (64 - used) : ~0ULL;
 }
 
 void CellularAutomaton::evolve() {
-    vector<int> new_state(state.size());
+    evolve(1);
+}
 
-    for (size_t i = 0; i < state.size(); i++) {
-        int left = (i > 0) ? state[i-1] : 0;
-        int center = state[i];
-        int right = (i < state.size()-1) ? state[i+1] : 0;
+// Mise à jour sur place, mot par mot : seul l'ancien mot précédent est gardé
+// pour fournir le voisin gauche de la première cellule du mot suivant
+void CellularAutomaton::evolve(size_t generations) {
+    size_t count = words.size();
+    if (count == 0) return;
 
-        new_state[i] = apply_rule(left, center, right);
+    // 256 cellules : un registre, sans bits inutilisés à masquer
+    if (cell_count == 256) {
+        Kernel256 kernel = kernelFor(active_backend());
+        if (kernel) {
+            kernel(words.data(), rule_mask, generations);
+            return;
+        }
     }
 
-    state = new_state;
+    for (size_t g = 0; g < generations; g++) {
+        uint64_t previous = 0; // Ancienne valeur du mot précédent (0 avant la première cellule)
+        for (size_t w = 0; w < count; w++) {
+            uint64_t center = words[w];
+            uint64_t next = (w + 1 < count) ? words[w + 1] : 0;
+            uint64_t left = (center >> 1) | (previous << 63);
+            uint64_t right = (center << 1) | (next >> 63);
+            words[w] = apply_rule_word(left, center, right);
+            previous = center;
+        }
+
+        // Les bits au-delà de la dernière cellule restent à 0 (bord de l'automate)
+        words[count - 1] &= last_mask;
+    }
 }
 
 void CellularAutomaton::print_state() const {
-    for (int cell : state) {
-        cout << (cell ? "#" : " ");
+    for (size_t i = 0; i < cell_count; i++) {
+        cout << (cell(i) ? "#" : " ");
     }
     cout << endl;
 }
 
 void CellularAutomaton::print_state_binary() const {
-    for (int cell : state) {
-        cout << cell;
+    for (size_t i = 0; i < cell_count; i++) {
+        cout << cell(i);
     }
     cout << endl;
 }
@@ -67,7 +225,27 @@ void CellularAutomaton::print_rule() const {
 }
 
 vector<int> CellularAutomaton::get_state() const {
+    vector<int> state(cell_count);
+    for (size_t i = 0; i < cell_count; i++) {
+        state[i] = cell(i);
+    }
     return state;
 }
 
+CellularAutomaton::Backend CellularAutomaton::active_backend() {
+    return static_cast<Backend>(currentBackend().load(std::memory_order_relaxed));
+}
+
+bool CellularAutomaton::set_backend(Backend backend) {
+    if (!cpuSupports(backend)) return false;
+    currentBackend().store(backend);
+    return true;
+}
 
+const char* CellularAutomaton::backend_name(Backend backend) {
+    switch (backend) {
+    case AVX512: return "AVX-512";
+    case AVX2: return "AVX2";
+    default: return "scalar";
+    }
+}
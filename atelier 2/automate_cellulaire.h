@@ -1,28 +1,65 @@
 #ifndef CELLULAR_AUTOMATON_H
 #define CELLULAR_AUTOMATON_H
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <bitset>
 
+// Les cellules sont rangées 64 par mot : la cellule i est le bit 63 - (i % 64)
+// du mot i / 64 (le mot se lit dans l'ordre des cellules). Une génération est
+// calculée sur des mots entiers, par décalages et opérations bit à bit, sans
+// allocation ; les cellules hors de l'automate valent 0.
+//
+// Un état de 256 cellules tient dans un registre AVX2 : il évolue alors en
+// vectoriel (AVX-512 ou AVX2 selon le processeur, choisi à l'exécution), avec
+// exactement le même résultat que le calcul mot par mot.
 class CellularAutomaton {
+public:
+    // Implémentations de evolve pour un état de 256 cellules
+    enum Backend {
+        SCALAR,  // Mot par mot (toutes les tailles)
+        AVX2,    // Un registre de 256 bits, règle appliquée par multiplexeurs
+        AVX512   // Idem, un vpternlogq par multiplexeur (AVX-512VL)
+    };
+
 private:
-    std::vector<int> state;
+    std::vector<uint64_t> words; // État courant, 64 cellules par mot
+    size_t cell_count;           // Nombre de cellules
+    uint64_t last_mask;          // Cellules valides du dernier mot (les autres restent à 0)
     int rule_number;
     int rule[8]; // Tableau de règles pour les 8 configurations possibles
-    
+    uint64_t rule_mask[8]; // rule[i] étendu à un mot entier (0 ou tous les bits à 1)
+
     void init_rule(int rule_num);
-    int apply_rule(int left, int center, int right);
-    
+
+    // Règle appliquée à 64 cellules à la fois (voisins gauches, cellules, voisins droits)
+    uint64_t apply_rule_word(uint64_t left, uint64_t center, uint64_t right) const;
+
+    int cell(size_t i) const { return (words[i / 64] >> (63 - i % 64)) & 1; }
+
 public:
     explicit CellularAutomaton(int rule_num);
-    
+
     void init_state(const std::vector<int>& initial_state);
     void evolve();
+
+    // Plusieurs générations d'un coup (l'état reste dans un registre en vectoriel)
+    void evolve(size_t generations);
     void print_state() const;
     void print_state_binary() const;
     void print_rule() const;
     std::vector<int> get_state() const;
+
+    // Implémentation utilisée pour les états de 256 cellules
+    static Backend active_backend();
+
+    // Forcer une implémentation (tests et mesures) ; false si le processeur ne la supporte pas
+    static bool set_backend(Backend backend);
+
+    // Nom lisible d'une implémentation
+    static const char* backend_name(Backend backend);
 };
 
-#endif // CELLULAR_AUTOMATON_H
\ No newline at end of file
+#endif // CELLULAR_AUTOMATON_H
@@ -4,6 +4,7 @@
 #include <iomanip>
 #include <iostream>
 #include <chrono>
+#include <limits>
 
 Block::Block(int index, const std::vector<Transaction>& transactions, 
              const std::string& previousHash, uint32_t hashRule, size_t hashSteps)
@@ -40,16 +41,31 @@ std::string Block::calculateHash() const {
     return ac_hash(ss.str(), hashRule, hashSteps);
 }
 
-long Block::mineBlock(int difficulty) {
+long Block::mineBlock(int difficulty, unsigned threads) {
     // Create a target string with leading zeros
-    std::string target(difficulty, '0');
+    const std::string target(difficulty, '0');
     
     // Record start time
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    // Increment nonce until we find a hash with the required number of leading zeros
-    while (hash.substr(0, difficulty) != target) {
-        nonce++;
+    // Everything before the nonce is fixed while mining
+    std::stringstream ss;
+    ss << index << timestamp << previousHash << merkleRoot;
+    const std::string prefix = ss.str();
+    
+    const uint32_t rule = hashRule;
+    const size_t steps = hashSteps;
+    const std::string& validatorRef = validator;
+    auto attempt = [&prefix, &validatorRef, &target, rule, steps, difficulty](uint64_t candidate) {
+        std::string candidateHash = ac_hash(prefix + std::to_string(candidate) + validatorRef, rule, steps);
+        return candidateHash.compare(0, difficulty, target) == 0;
+    };
+    
+    // Split the nonce space between the workers; the first valid nonce wins
+    MiningResult result = mineParallel(threads, nonce, std::numeric_limits<uint64_t>::max(), 
+                                       eachNonce(attempt));
+    if (result.found) {
+        nonce = result.nonce;
         hash = calculateHash();
     }
     
@@ -57,10 +73,15 @@ long Block::mineBlock(int difficulty) {
     auto endTime = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
     
-    std::cout << "Block mined! Hash: " << hash << std::endl;
-    std::cout << "Mining time: " << duration << " ms" << std::endl;
+    if (result.found) {
+        std::cout << "Block mined! Hash: " << hash << std::endl;
+    } else {
+        std::cout << "Mining of block #" << index << " failed: no nonce meets the difficulty" << std::endl;
+    }
+    std::cout << "Mining time: " << duration << " ms (" << result.totalHashes() 
+              << " hashes, " << result.hashesPerThread.size() << " threads)" << std::endl;
     
-    return duration;
+    return result.found ? duration : -1;
 }
 
 long Block::validateBlock(const std::string& validatorAddress) {
@@ -6,6 +6,7 @@
 #include <ctime>
 #include "merkle_tree.h"
 #include "transaction.h"
+#include "../common/parallel_miner.h"
 
 /**
  * Represents a block in the blockchain using AC-based hashing
@@ -18,7 +19,7 @@ private:
     std::string previousHash;    // Hash of the previous block
     std::string merkleRoot;      // Merkle root of transactions
     std::vector<Transaction> transactions; // Transactions in this block
-    int nonce;                   // Nonce for PoW
+    uint64_t nonce;              // Nonce for PoW
     std::string validator;       // Validator address for PoS
     std::string hash;            // Hash of this block
     uint32_t hashRule;           // CA rule for hashing (default: 30)
@@ -51,9 +52,11 @@ public:
      * Mine the block with Proof of Work
      * 
      * @param difficulty Mining difficulty (number of leading zeros)
-     * @return Time taken to mine the block in milliseconds
+     * @param threads Number of worker threads sharing the nonce space
+     * @return Time taken to mine the block in milliseconds, or -1 if no nonce
+     *         of the 64-bit space meets the difficulty (the block is then unchanged)
      */
-    long mineBlock(int difficulty);
+    long mineBlock(int difficulty, unsigned threads = 1);
     
     /**
      * Validate the block with Proof of Stake
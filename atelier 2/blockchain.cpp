@@ -5,7 +5,8 @@
 
 Blockchain::Blockchain(bool usePoS, int difficulty, uint32_t hashRule, size_t hashSteps)
     : difficulty(difficulty), totalStake(0), usePoS(usePoS), 
-      hashRule(hashRule), hashSteps(hashSteps), rng(std::random_device()()) {
+      hashRule(hashRule), hashSteps(hashSteps), miningThreads(defaultWorkerThreads()),
+      rng(std::random_device()()) {
     createGenesisBlock();
 }
 
@@ -46,8 +47,11 @@ long Blockchain::addBlock(const std::vector<Transaction>& transactions) {
         std::string validator = selectValidator();
         blockTime = newBlock.validateBlock(validator);
     } else {
-        // Mine the block with the current difficulty
-        blockTime = newBlock.mineBlock(difficulty);
+        // Mine the block with the current difficulty; a block without a valid nonce is not added
+        blockTime = newBlock.mineBlock(difficulty, miningThreads);
+        if (blockTime < 0) {
+            return -1;
+        }
     }
     
     // Add the new block to the chain
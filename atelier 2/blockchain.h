@@ -29,6 +29,7 @@ private:
     bool usePoS;                        // Whether to use PoS (true) or PoW (false)
     uint32_t hashRule;                  // CA rule for hashing (default: 30)
     size_t hashSteps;                   // CA steps for hashing (default: 100)
+    unsigned miningThreads;             // Number of threads used to mine a block
     
     mutable std::mt19937 rng;           // Random number generator for PoS
     
@@ -65,7 +66,8 @@ public:
      * Add a new block with the given transactions
      * 
      * @param transactions List of transactions to include in the block
-     * @return Time taken to add the block in milliseconds
+     * @return Time taken to add the block in milliseconds, or -1 if mining
+     *         failed and nothing was added
      */
     long addBlock(const std::vector<Transaction>& transactions);
     
@@ -114,6 +116,16 @@ public:
      */
     void setDifficulty(int newDifficulty) { difficulty = newDifficulty; }
     
+    /**
+     * Get the number of mining threads
+     */
+    unsigned getMiningThreads() const { return miningThreads; }
+    
+    /**
+     * Set the number of mining threads (defaults to the hardware thread count)
+     */
+    void setMiningThreads(unsigned threads) { miningThreads = threads > 0 ? threads : 1; }
+    
     /**
      * Switch between PoW and PoS
      */
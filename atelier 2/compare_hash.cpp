@@ -5,7 +5,7 @@
 #include <random>
 #include <sstream>
 #include <ctime>
-#include <openssl/sha.h>
+#include "../crypto/sha256.h"
 
 // Include AC hash implementation
 #include "hash.h"
@@ -29,19 +29,9 @@ struct SimpleTransaction {
     }
 };
 
-// SHA-256 helper function
-std::string sha256(const std::string& str) {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, str.c_str(), str.size());
-    SHA256_Final(hash, &sha256);
-    
-    std::stringstream ss;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i];
-    }
-    return ss.str();
+// SHA-256 helper function (hex digest, like ac_hash)
+std::string sha256Hex(const std::string& str) {
+    return sha256(str).toHex();
 }
 
 // Simplified block structure for testing
@@ -88,7 +78,7 @@ MiningResult mineWithSHA256(TestBlock& block, int difficulty) {
         iterations++;
         std::stringstream ss;
         ss << blockData << block.nonce;
-        block.hash = sha256(ss.str());
+        block.hash = sha256Hex(ss.str());
     } while (block.hash.substr(0, difficulty) != target);
     
     auto endTime = std::chrono::high_resolution_clock::now();
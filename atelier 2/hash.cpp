@@ -88,10 +88,8 @@ string ac_hash(const string& input, uint32_t rule, size_t steps) {
     CellularAutomaton ca(rule);
     ca.init_state(initial_state);
     
-    // Évolution de l'automate pendant 'steps' générations
-    for (size_t i = 0; i < steps; i++) {
-        ca.evolve();
-    }
+    // Évolution de l'automate pendant 'steps' générations (en registre si possible)
+    ca.evolve(steps);
     
     // Récupération de l'état final et conversion en hexadécimal
     vector<int> final_state = ca.get_state();
@@ -2,18 +2,23 @@
 #include <iostream>
 #include <cmath>
 
-MerkleTreeAC::MerkleTreeAC(const std::vector<std::string>& data, uint32_t rule, size_t steps)
-    : rule(rule), steps(steps) {
+const size_t MerkleTreeAC::PARALLEL_THRESHOLD;
+
+MerkleTreeAC::MerkleTreeAC(const std::vector<std::string>& data, uint32_t rule, size_t steps,
+                           unsigned threads)
+    : rule(rule), steps(steps), threads(threads) {
     if (data.empty()) {
         rootHash = ac_hash("empty_merkle_root", rule, steps);
         return;
     }
     
-    // Hash each piece of data to create leaf nodes
-    std::vector<std::string> leaves;
-    for (const auto& item : data) {
-        leaves.push_back(ac_hash(item, rule, steps));
-    }
+    // Hash each piece of data to create leaf nodes, split between the threads
+    std::vector<std::string> leaves(data.size());
+    parallelFor(data.size(), PARALLEL_THRESHOLD, threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            leaves[i] = ac_hash(data[i], rule, steps);
+        }
+    });
     
     // Build the tree
     buildTree(leaves);
@@ -26,20 +31,21 @@ void MerkleTreeAC::buildTree(const std::vector<std::string>& leaves) {
     
     // Build tree level by level
     while (currentLevel.size() > 1) {
-        std::vector<std::string> nextLevel;
+        std::vector<std::string> nextLevel((currentLevel.size() + 1) / 2);
         
-        // Process pairs of nodes
-        for (size_t i = 0; i < currentLevel.size(); i += 2) {
-            if (i + 1 < currentLevel.size()) {
-                // Hash pair of nodes
-                std::string combined = hashPair(currentLevel[i], currentLevel[i + 1]);
-                nextLevel.push_back(combined);
-            } else {
-                // Odd node out - hash with itself
-                std::string combined = hashPair(currentLevel[i], currentLevel[i]);
-                nextLevel.push_back(combined);
+        // Process pairs of nodes, each thread filling its own range of parents
+        parallelFor(nextLevel.size(), PARALLEL_THRESHOLD, threads, [&](size_t begin, size_t end) {
+            for (size_t parent = begin; parent < end; parent++) {
+                size_t i = 2 * parent;
+                if (i + 1 < currentLevel.size()) {
+                    // Hash pair of nodes
+                    nextLevel[parent] = hashPair(currentLevel[i], currentLevel[i + 1]);
+                } else {
+                    // Odd node out - hash with itself
+                    nextLevel[parent] = hashPair(currentLevel[i], currentLevel[i]);
+                }
             }
-        }
+        });
         
         // Add this level to the tree
         tree.insert(tree.end(), nextLevel.begin(), nextLevel.end());
@@ -50,7 +56,7 @@ void MerkleTreeAC::buildTree(const std::vector<std::string>& leaves) {
     rootHash = currentLevel[0];
 }
 
-std::string MerkleTreeAC::hashPair(const std::string& left, const std::string& right) {
+std::string MerkleTreeAC::hashPair(const std::string& left, const std::string& right) const {
     // Combine the two hashes and hash again using AC hash
     std::string combined = left + right;
     return ac_hash(combined, rule, steps);
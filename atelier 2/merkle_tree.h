@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include "hash.h"
+#include "../common/parallel_for.h"
 
 /**
  * A Merkle Tree implementation using AC-based hashing
@@ -16,6 +17,8 @@ private:
     uint32_t rule;      // CA rule to use for hashing
     size_t steps;       // Number of CA steps
     
+    unsigned threads;   // Threads used to build the tree (0 = one per hardware thread)
+    
     /**
      * Build the Merkle tree from leaf nodes
      */
@@ -24,17 +27,26 @@ private:
     /**
      * Hash two strings together using AC hash
      */
-    std::string hashPair(const std::string& left, const std::string& right);
+    std::string hashPair(const std::string& left, const std::string& right) const;
 
 public:
+    /**
+     * Below this many hashes per thread, leaves and levels are hashed serially
+     * (an AC hash runs the automaton for many steps, so the threshold is low)
+     */
+    static const size_t PARALLEL_THRESHOLD = 8;
+    
     /**
      * Constructor
      * 
      * @param data List of data strings (transactions)
      * @param rule CA rule number (default: 30)
      * @param steps Number of CA evolution steps (default: 100)
+     * @param threads Number of threads hashing leaves and levels (0 = one per
+     *                hardware thread); the root does not depend on it
      */
-    MerkleTreeAC(const std::vector<std::string>& data, uint32_t rule = 30, size_t steps = 100);
+    MerkleTreeAC(const std::vector<std::string>& data, uint32_t rule = 30, size_t steps = 100,
+                 unsigned threads = 0);
     
     /**
      * Get the root hash of the tree
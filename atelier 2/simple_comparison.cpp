@@ -6,24 +6,14 @@
 #include <bitset>
 #include <cmath>
 #include <algorithm>
-#include <openssl/sha.h>
+#include "../crypto/sha256.h"
 
 // Include AC hash implementation
 #include "hash.h"
 
-// SHA-256 helper function
-std::string sha256(const std::string& str) {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, str.c_str(), str.size());
-    SHA256_Final(hash, &sha256);
-    
-    std::stringstream ss;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i];
-    }
-    return ss.str();
+// SHA-256 helper function (hex digest, like ac_hash)
+std::string sha256Hex(const std::string& str) {
+    return sha256(str).toHex();
 }
 
 // Print table separator
@@ -295,7 +285,7 @@ int main() {
     
     std::string sha256Result;
     for (int i = 0; i < NUM_HASHES; i++) {
-        sha256Result = sha256(testInput + std::to_string(i));
+        sha256Result = sha256Hex(testInput + std::to_string(i));
     }
     
     auto sha256End = std::chrono::high_resolution_clock::now();
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "automate_cellulaire.h"
+
+// Afficher le résultat d'un test
+void displayTestResult(const std::string& testName, bool result) {
+    std::cout << "Test " << testName << ": " << (result ? "PASSED" : "FAILED") << std::endl;
+}
+
+// Génération de référence, cellule par cellule (bords à 0)
+std::vector<int> referenceEvolve(int rule, const std::vector<int>& state) {
+    std::vector<int> next(state.size());
+    for (size_t i = 0; i < state.size(); i++) {
+        int left = (i > 0) ? state[i - 1] : 0;
+        int right = (i + 1 < state.size()) ? state[i + 1] : 0;
+        next[i] = (rule >> ((left << 2) | (state[i] << 1) | right)) & 1;
+    }
+    return next;
+}
+
+// Chaque règle, sur des états aléatoires dont la taille tombe sur et autour
+// des frontières de mots : une génération à la fois puis plusieurs d'un coup
+bool testMatchesReference() {
+    const size_t sizes[] = { 1, 63, 64, 65, 256, 300 };
+    const size_t generations = 20;
+    std::mt19937 rng(42);
+    bool ok = true;
+
+    for (int rule = 0; rule < 256; rule++) {
+        for (size_t size : sizes) {
+            std::vector<int> state(size);
+            for (size_t i = 0; i < size; i++) {
+                state[i] = rng() & 1;
+            }
+
+            CellularAutomaton stepped(rule);
+            CellularAutomaton batched(rule);
+            stepped.init_state(state);
+            batched.init_state(state);
+            std::vector<int> expected = state;
+            for (size_t g = 0; g < generations; g++) {
+                expected = referenceEvolve(rule, expected);
+                stepped.evolve();
+                if (stepped.get_state() != expected) {
+                    std::cout << "Règle " << rule << ", " << size << " cellules : écart à la génération "
+                              << g + 1 << std::endl;
+                    ok = false;
+                    break;
+                }
+            }
+            batched.evolve(generations);
+            if (batched.get_state() != expected) {
+                std::cout << "Règle " << rule << ", " << size << " cellules : écart après "
+                          << generations << " générations d'un coup" << std::endl;
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+// Chaque implémentation forcée, sur des états de 256 cellules (les seuls
+// calculés en vectoriel), donne l'état du calcul mot par mot
+bool testBackendsMatchScalar() {
+    const CellularAutomaton::Backend backends[] = { CellularAutomaton::AVX2, CellularAutomaton::AVX512 };
+    const size_t generations = 100;
+    std::mt19937 rng(7);
+    bool ok = true;
+
+    for (CellularAutomaton::Backend backend : backends) {
+        if (!CellularAutomaton::set_backend(backend)) {
+            std::cout << CellularAutomaton::backend_name(backend) << " non supporté : ignoré" << std::endl;
+            continue;
+        }
+        for (int rule = 0; rule < 256; rule++) {
+            std::vector<int> state(256);
+            for (size_t i = 0; i < state.size(); i++) {
+                state[i] = rng() & 1;
+            }
+
+            CellularAutomaton vectorized(rule);
+            vectorized.init_state(state);
+            vectorized.evolve(generations);
+
+            CellularAutomaton::set_backend(CellularAutomaton::SCALAR);
+            CellularAutomaton scalar(rule);
+            scalar.init_state(state);
+            scalar.evolve(generations);
+            CellularAutomaton::set_backend(backend);
+
+            if (vectorized.get_state() != scalar.get_state()) {
+                std::cout << CellularAutomaton::backend_name(backend) << ", règle " << rule
+                          << " : écart avec le calcul mot par mot" << std::endl;
+                ok = false;
+            }
+        }
+    }
+    CellularAutomaton::set_backend(CellularAutomaton::SCALAR);
+    return ok;
+}
+
+int main() {
+    std::cout << "===== TESTS DE L'AUTOMATE CELLULAIRE =====" << std::endl << std::endl;
+
+    // Le calcul mot par mot sert à toutes les tailles
+    CellularAutomaton::set_backend(CellularAutomaton::SCALAR);
+    bool matchesReference = testMatchesReference();
+    bool backendsMatch = testBackendsMatchScalar();
+    std::cout << std::endl;
+    displayTestResult("Matches per-cell reference", matchesReference);
+    displayTestResult("Backends match scalar", backendsMatch);
+
+    bool allPassed = matchesReference && backendsMatch;
+    std::cout << std::endl << (allPassed ? "All tests passed!" : "Some tests failed!") << std::endl;
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Monotonic arena: hands out memory from large blocks and frees it all at once
+ *
+ * Meant for short-lived temporaries built in bulk (e.g. the serialized
+ * transactions of a block while its Merkle root is computed): allocation is a
+ * pointer bump, there is no per-object free, and destroying or resetting the
+ * arena releases everything. Objects placed in it must not need destructors.
+ */
+class MonotonicArena {
+public:
+    /**
+     * @param blockSize Size of each block requested from the heap (larger
+     *                  allocations get a block of their own)
+     */
+    explicit MonotonicArena(size_t blockSize = 64 * 1024)
+        : blockSize(blockSize > 0 ? blockSize : 1), cursor(nullptr), remaining(0) {}
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    /**
+     * Get size bytes aligned on alignment (a power of two)
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        size_t padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+        if (cursor == nullptr || padding + size > remaining) {
+            addBlock(size + alignment);
+            padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+        }
+        char* result = cursor + padding;
+        cursor = result + size;
+        remaining -= padding + size;
+        return result;
+    }
+
+    /**
+     * Release everything but the first block, which is reused
+     */
+    void reset() {
+        if (blocks.empty()) return;
+        blocks.resize(1);
+        cursor = blocks[0].data.get();
+        remaining = blocks[0].size;
+    }
+
+    /**
+     * Number of blocks currently held
+     */
+    size_t getBlockCount() const { return blocks.size(); }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t blockSize;
+    char* cursor;       // Next free byte of the current block
+    size_t remaining;   // Bytes left in the current block
+
+    void addBlock(size_t minimum) {
+        Block block;
+        block.size = minimum > blockSize ? minimum : blockSize;
+        block.data.reset(new char[block.size]);
+        cursor = block.data.get();
+        remaining = block.size;
+        blocks.push_back(std::move(block));
+    }
+};
+
+#endif // ARENA_H
@@ -0,0 +1,62 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * Number of threads to use when none is given (one per hardware thread)
+ */
+inline unsigned defaultWorkerThreads() {
+    unsigned count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+/**
+ * Run body(begin, end) over [0, count) split into contiguous ranges, one per thread
+ *
+ * Each thread gets at least serialThreshold items, so small inputs run in the
+ * calling thread without starting any. Ranges do not overlap: bodies writing
+ * only to their own items need no synchronization.
+ *
+ * @param count Number of items
+ * @param serialThreshold Smallest number of items worth a thread of its own
+ * @param threads Largest number of threads to use (0 = one per hardware thread)
+ * @param body Called as body(size_t begin, size_t end)
+ */
+template <typename Body>
+void parallelFor(size_t count, size_t serialThreshold, unsigned threads, Body body) {
+    if (threads == 0) threads = defaultWorkerThreads();
+    if (serialThreshold == 0) serialThreshold = 1;
+
+    size_t useful = count / serialThreshold;
+    size_t threadCount = useful < threads ? useful : threads;
+    if (threadCount <= 1) {
+        body(static_cast<size_t>(0), count);
+        return;
+    }
+
+    // The calling thread takes the first range
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    size_t chunk = count / threadCount;
+    size_t remainder = count % threadCount;
+    size_t begin = 0;
+    size_t firstEnd = 0;
+    for (size_t t = 0; t < threadCount; t++) {
+        size_t end = begin + chunk + (t < remainder ? 1 : 0);
+        if (t == 0) {
+            firstEnd = end;
+        } else {
+            workers.emplace_back(body, begin, end);
+        }
+        begin = end;
+    }
+    body(static_cast<size_t>(0), firstEnd);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+#endif // PARALLEL_FOR_H
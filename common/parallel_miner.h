@@ -0,0 +1,134 @@
+#ifndef PARALLEL_MINER_H
+#define PARALLEL_MINER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "parallel_for.h"
+
+/**
+ * Outcome of a parallel nonce search
+ */
+struct MiningResult {
+    bool found;                            // Whether a valid nonce was found in the range
+    uint64_t nonce;                        // Winning nonce (valid only if found)
+    std::vector<uint64_t> hashesPerThread; // Attempts made by each worker
+
+    MiningResult() : found(false), nonce(0) {}
+
+    /**
+     * Total number of attempts across all workers
+     */
+    uint64_t totalHashes() const {
+        uint64_t total = 0;
+        for (uint64_t count : hashesPerThread) total += count;
+        return total;
+    }
+};
+
+/**
+ * Search a chunk of nonces [begin, end)
+ *
+ * Returns true and sets nonce when a valid one is found; adds the number of
+ * hashes computed to tried. Chunks let a searcher hash several nonces at once
+ * (e.g. multi-buffer SHA-256) and keep the cancellation checks off the
+ * per-nonce path. Must be safe to call from several threads at once.
+ */
+typedef std::function<bool(uint64_t begin, uint64_t end, uint64_t& nonce, uint64_t& tried)> NonceSearch;
+
+/**
+ * Nonces handed to a worker at a time; workers check for cancellation between chunks
+ */
+const uint64_t NONCE_CHUNK = 256;
+
+/**
+ * Adapts a per-nonce predicate bool(uint64_t nonce) to a chunk searcher
+ */
+template <typename Predicate>
+struct EachNonce {
+    Predicate predicate;
+
+    bool operator()(uint64_t begin, uint64_t end, uint64_t& nonce, uint64_t& tried) const {
+        for (uint64_t candidate = begin; candidate < end; candidate++) {
+            tried++;
+            if (predicate(candidate)) {
+                nonce = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+template <typename Predicate>
+EachNonce<Predicate> eachNonce(Predicate predicate) {
+    EachNonce<Predicate> search = {predicate};
+    return search;
+}
+
+/**
+ * Search the nonce range [firstNonce, endNonce) with several threads
+ *
+ * The range is cut into chunks of NONCE_CHUNK nonces dealt round-robin:
+ * worker t takes chunks t, t + threadCount, ... so low nonces are tried
+ * first. All workers stop as soon as one of them finds a valid nonce.
+ *
+ * @param threadCount Number of workers (1 runs in the calling thread)
+ * @param firstNonce First nonce of the range
+ * @param endNonce One past the last nonce of the range
+ * @param search Chunk searcher (see NonceSearch), copied once per worker so it
+ *               can keep per-thread scratch state
+ * @return Winning nonce and per-thread attempt counts
+ */
+template <typename Search>
+MiningResult mineParallel(unsigned threadCount, uint64_t firstNonce, uint64_t endNonce, Search search) {
+    if (threadCount == 0) threadCount = 1;
+
+    MiningResult result;
+    result.hashesPerThread.assign(threadCount, 0);
+    // Rounded up without overflowing when the range spans the whole 64-bit nonce space
+    const uint64_t nonceCount = endNonce > firstNonce ? endNonce - firstNonce : 0;
+    const uint64_t chunkCount = nonceCount / NONCE_CHUNK + (nonceCount % NONCE_CHUNK != 0 ? 1 : 0);
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> winner(0);
+
+    auto worker = [&](unsigned t, Search localSearch) {
+        uint64_t tried = 0;
+        for (uint64_t chunk = t; chunk < chunkCount; chunk += threadCount) {
+            if (stop.load(std::memory_order_relaxed)) break;
+            uint64_t begin = firstNonce + chunk * NONCE_CHUNK;
+            uint64_t end = (endNonce - begin > NONCE_CHUNK) ? begin + NONCE_CHUNK : endNonce;
+            uint64_t nonce = 0;
+            if (localSearch(begin, end, nonce, tried)) {
+                // Only the first finder publishes its nonce
+                if (!stop.exchange(true)) {
+                    winner.store(nonce);
+                }
+                break;
+            }
+        }
+        result.hashesPerThread[t] = tried;
+    };
+
+    if (threadCount == 1) {
+        worker(0, search);
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount);
+        for (unsigned t = 0; t < threadCount; t++) {
+            workers.emplace_back(worker, t, search);
+        }
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    }
+
+    result.found = stop.load();
+    result.nonce = winner.load();
+    return result;
+}
+
+#endif // PARALLEL_MINER_H
@@ -0,0 +1,74 @@
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+#include <cstdint>
+#include <cstring>
+#include "../crypto/hash256.h"
+
+/**
+ * Fixed-width encoding helpers for binary headers (little-endian) and
+ * SHA-256 words (big-endian)
+ *
+ * Each write function stores its value at out and returns the position
+ * just after it, so a header is written field by field:
+ *     uint8_t* p = writeLE32(buffer, index);
+ *     p = writeHash(p, previousHash);
+ */
+
+inline uint8_t* writeLE32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    return out + 4;
+}
+
+inline uint8_t* writeLE64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    return out + 8;
+}
+
+inline uint8_t* writeBE32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>(value >> (24 - 8 * i));
+    }
+    return out + 4;
+}
+
+inline uint8_t* writeHash(uint8_t* out, const Hash256& hash) {
+    std::memcpy(out, hash.bytes, Hash256::SIZE);
+    return out + Hash256::SIZE;
+}
+
+inline uint32_t readLE32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+inline uint64_t readLE64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+inline uint32_t readBE32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+inline Hash256 readHash(const uint8_t* in) {
+    Hash256 hash;
+    std::memcpy(hash.bytes, in, Hash256::SIZE);
+    return hash;
+}
+
+#endif // SERIALIZE_H
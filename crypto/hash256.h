@@ -0,0 +1,127 @@
+#ifndef HASH256_H
+#define HASH256_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <ostream>
+
+/**
+ * Fixed-size 256-bit digest (SHA-256 output, Merkle node, block hash)
+ * Stored as 32 raw bytes; hex is only produced for display and serialization
+ */
+struct Hash256 {
+    static constexpr size_t SIZE = 32;
+    uint8_t bytes[SIZE];
+
+    /**
+     * The all-zero hash (used as "no previous block" and empty root)
+     */
+    static Hash256 zero() {
+        Hash256 h = {};
+        return h;
+    }
+
+    /**
+     * Parse a 64-character hex string
+     *
+     * @param hex Hex representation (upper or lower case)
+     * @param out Parsed digest
+     * @return true if the string was a valid 256-bit hex value
+     */
+    static bool fromHex(const std::string& hex, Hash256& out) {
+        if (hex.size() != 2 * SIZE) return false;
+        for (size_t i = 0; i < SIZE; i++) {
+            int hi = hexValue(hex[2 * i]);
+            int lo = hexValue(hex[2 * i + 1]);
+            if (hi < 0 || lo < 0) return false;
+            out.bytes[i] = static_cast<uint8_t>((hi << 4) | lo);
+        }
+        return true;
+    }
+
+    /**
+     * Convert to a 64-character lowercase hex string
+     */
+    std::string toHex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex(2 * SIZE, '0');
+        for (size_t i = 0; i < SIZE; i++) {
+            hex[2 * i] = digits[bytes[i] >> 4];
+            hex[2 * i + 1] = digits[bytes[i] & 0x0f];
+        }
+        return hex;
+    }
+
+    /**
+     * Check whether every byte is zero
+     */
+    bool isZero() const {
+        for (size_t i = 0; i < SIZE; i++) {
+            if (bytes[i] != 0) return false;
+        }
+        return true;
+    }
+
+    /**
+     * Number of leading zero hex digits (what the PoW difficulty counts)
+     */
+    int leadingZeroNibbles() const {
+        int count = 0;
+        for (size_t i = 0; i < SIZE; i++) {
+            if (bytes[i] == 0) {
+                count += 2;
+                continue;
+            }
+            if ((bytes[i] & 0xf0) == 0) count++;
+            break;
+        }
+        return count;
+    }
+
+    /**
+     * Check the PoW condition "at least n leading zero hex digits"
+     * Only the first (n + 1) / 2 bytes are inspected
+     */
+    bool hasLeadingZeroNibbles(int n) const {
+        if (n > static_cast<int>(2 * SIZE)) return false;
+        int fullBytes = n / 2;
+        for (int i = 0; i < fullBytes; i++) {
+            if (bytes[i] != 0) return false;
+        }
+        return (n % 2 == 0) || (bytes[fullBytes] & 0xf0) == 0;
+    }
+
+    const uint8_t* data() const { return bytes; }
+    uint8_t* data() { return bytes; }
+
+private:
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+};
+
+namespace hash256_detail {
+    constexpr bool equalFrom(const Hash256& a, const Hash256& b, size_t i) {
+        return i == Hash256::SIZE || (a.bytes[i] == b.bytes[i] && equalFrom(a, b, i + 1));
+    }
+
+    constexpr bool lessFrom(const Hash256& a, const Hash256& b, size_t i) {
+        return i != Hash256::SIZE &&
+               (a.bytes[i] < b.bytes[i] || (a.bytes[i] == b.bytes[i] && lessFrom(a, b, i + 1)));
+    }
+}
+
+constexpr bool operator==(const Hash256& a, const Hash256& b) { return hash256_detail::equalFrom(a, b, 0); }
+constexpr bool operator!=(const Hash256& a, const Hash256& b) { return !(a == b); }
+constexpr bool operator<(const Hash256& a, const Hash256& b) { return hash256_detail::lessFrom(a, b, 0); }
+
+// Display as hex so existing "<< hash" output keeps its format
+inline std::ostream& operator<<(std::ostream& os, const Hash256& h) {
+    return os << h.toHex();
+}
+
+#endif // HASH256_H
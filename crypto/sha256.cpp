@@ -0,0 +1,283 @@
+#include "sha256.h"
+#include "../common/serialize.h"
+#include <atomic>
+#include <cstring>
+#include <openssl/evp.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SHA256_X86 1
+#endif
+
+const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+const uint32_t SHA256_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+namespace {
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// Portable compression of one 64-byte block
+void compressPortable(uint32_t state[8], const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = readBE32(block + 4 * i);
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + S1 + ch + SHA256_K[i] + w[i];
+        uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = S0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+#ifdef SHA256_X86
+
+// SHA-NI compression; the hardware works on the state as (ABEF, CDGH) pairs
+__attribute__((target("sha,sse4.1")))
+void compressShaNi(uint32_t state[8], const uint8_t* blocks, size_t count) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+    __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+    __m128i cdab = _mm_shuffle_epi32(dcba, 0xB1);
+    __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+    for (size_t b = 0; b < count; b++) {
+        const uint8_t* block = blocks + b * 64;
+        __m128i savedAbef = abef;
+        __m128i savedCdgh = cdgh;
+        __m128i w[4];
+
+        // 16 groups of 4 rounds; w[i & 3] holds message words 4i..4i+3
+        for (int i = 0; i < 16; i++) {
+            if (i < 4) {
+                w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i)), byteSwap);
+            } else {
+                __m128i next = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+                w[i & 3] = _mm_sha256msg2_epu32(next, w[(i + 3) & 3]);
+            }
+            __m128i wk = _mm_add_epi32(w[i & 3], _mm_loadu_si128(reinterpret_cast<const __m128i*>(SHA256_K + 4 * i)));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0E));
+        }
+
+        abef = _mm_add_epi32(abef, savedAbef);
+        cdgh = _mm_add_epi32(cdgh, savedCdgh);
+    }
+
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+#endif // SHA256_X86
+
+bool cpuSupports(Sha256Backend backend) {
+    switch (backend) {
+    case SHA256_OPENSSL:
+        return true;
+#ifdef SHA256_X86
+    case SHA256_SHANI:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+#endif
+    default:
+        return false;
+    }
+}
+
+std::atomic<int>& currentBackend() {
+    static std::atomic<int> backend(cpuSupports(SHA256_SHANI) ? SHA256_SHANI : SHA256_OPENSSL);
+    return backend;
+}
+
+// Bytes of padding (0x80, zeros, 64-bit big-endian bit length) after a message of `length` bytes
+size_t writePadding(uint64_t length, uint8_t* out) {
+    size_t used = static_cast<size_t>(length % 64);
+    size_t size = (used < 56) ? 64 - used : 128 - used;
+    std::memset(out, 0, size);
+    out[0] = 0x80;
+    uint64_t bitLength = length * 8;
+    for (int i = 0; i < 8; i++) {
+        out[size - 1 - i] = static_cast<uint8_t>(bitLength >> (8 * i));
+    }
+    return size;
+}
+
+} // namespace
+
+void sha256Compress(uint32_t state[8], const uint8_t* blocks, size_t count) {
+#ifdef SHA256_X86
+    if (sha256Backend() == SHA256_SHANI) {
+        compressShaNi(state, blocks, count);
+        return;
+    }
+#endif
+    for (size_t b = 0; b < count; b++) {
+        compressPortable(state, blocks + b * 64);
+    }
+}
+
+Hash256 sha256(const unsigned char* data, size_t len) {
+    Hash256 hash;
+    if (sha256Backend() != SHA256_SHANI) {
+        EVP_Digest(data, len, hash.bytes, nullptr, EVP_sha256(), nullptr);
+        return hash;
+    }
+
+    uint32_t state[8];
+    std::memcpy(state, SHA256_IV, sizeof(state));
+    size_t whole = len / 64;
+    sha256Compress(state, data, whole);
+
+    // Last partial block and padding, at most two blocks
+    uint8_t tail[128];
+    size_t rest = len - whole * 64;
+    std::memcpy(tail, data + whole * 64, rest);
+    size_t size = rest + writePadding(len, tail + rest);
+    sha256Compress(state, tail, size / 64);
+
+    for (int i = 0; i < 8; i++) {
+        writeBE32(hash.bytes + 4 * i, state[i]);
+    }
+    return hash;
+}
+
+Hash256 sha256(const std::string& str) {
+    return sha256(reinterpret_cast<const unsigned char*>(str.data()), str.size());
+}
+
+Sha256::Sha256() : evp(nullptr) {
+    if (sha256Backend() != SHA256_SHANI) {
+        evp = EVP_MD_CTX_new();
+    }
+    reset();
+}
+
+Sha256::~Sha256() {
+    if (evp) EVP_MD_CTX_free(evp);
+}
+
+Sha256::Sha256(const Sha256& other) : evp(nullptr) {
+    *this = other;
+}
+
+Sha256& Sha256::operator=(const Sha256& other) {
+    if (this == &other) return *this;
+    if (other.evp) {
+        if (!evp) evp = EVP_MD_CTX_new();
+        EVP_MD_CTX_copy_ex(evp, other.evp);
+    } else if (evp) {
+        EVP_MD_CTX_free(evp);
+        evp = nullptr;
+    }
+    std::memcpy(state, other.state, sizeof(state));
+    std::memcpy(buffer, other.buffer, sizeof(buffer));
+    buffered = other.buffered;
+    length = other.length;
+    return *this;
+}
+
+Sha256& Sha256::update(const void* data, size_t len) {
+    if (evp) {
+        EVP_DigestUpdate(evp, data, len);
+        return *this;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    length += len;
+    if (buffered > 0) {
+        size_t take = (len < 64 - buffered) ? len : 64 - buffered;
+        std::memcpy(buffer + buffered, bytes, take);
+        buffered += take;
+        bytes += take;
+        len -= take;
+        if (buffered < 64) return *this;
+        sha256Compress(state, buffer, 1);
+        buffered = 0;
+    }
+    size_t whole = len / 64;
+    sha256Compress(state, bytes, whole);
+    buffered = len - whole * 64;
+    std::memcpy(buffer, bytes + whole * 64, buffered);
+    return *this;
+}
+
+Sha256& Sha256::update(const std::string& str) {
+    return update(str.data(), str.size());
+}
+
+Hash256 Sha256::finish() {
+    Hash256 hash;
+    if (evp) {
+        EVP_DigestFinal_ex(evp, hash.bytes, nullptr);
+    } else {
+        uint8_t tail[128];
+        std::memcpy(tail, buffer, buffered);
+        size_t size = buffered + writePadding(length, tail + buffered);
+        sha256Compress(state, tail, size / 64);
+        for (int i = 0; i < 8; i++) {
+            writeBE32(hash.bytes + 4 * i, state[i]);
+        }
+    }
+    reset();
+    return hash;
+}
+
+void Sha256::reset() {
+    if (evp) {
+        EVP_DigestInit_ex(evp, EVP_sha256(), nullptr);
+    }
+    std::memcpy(state, SHA256_IV, sizeof(state));
+    buffered = 0;
+    length = 0;
+}
+
+Sha256Backend sha256Backend() {
+    return static_cast<Sha256Backend>(currentBackend().load(std::memory_order_relaxed));
+}
+
+bool setSha256Backend(Sha256Backend backend) {
+    if (!cpuSupports(backend)) return false;
+    currentBackend().store(backend);
+    return true;
+}
+
+const char* sha256BackendName(Sha256Backend backend) {
+    switch (backend) {
+    case SHA256_SHANI: return "SHA-NI";
+    default: return "OpenSSL EVP";
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "hash256.h"
+
+struct evp_md_ctx_st;
+
+/**
+ * SHA-256 implementation used by every hash in the project
+ *
+ * Uses the Intel SHA extensions (SHA-NI) when the CPU has them, OpenSSL's
+ * EVP interface otherwise. The choice is made once at runtime.
+ */
+enum Sha256Backend {
+    SHA256_OPENSSL,
+    SHA256_SHANI
+};
+
+/**
+ * Hash a buffer in one call
+ */
+Hash256 sha256(const unsigned char* data, size_t len);
+
+/**
+ * Hash a string in one call
+ */
+Hash256 sha256(const std::string& str);
+
+/**
+ * Streaming SHA-256: feed the message in pieces, then call finish()
+ *
+ * Copying a context copies its state, so a common prefix can be hashed once
+ * and the copies finished with different suffixes.
+ */
+class Sha256 {
+private:
+    evp_md_ctx_st* evp;     // OpenSSL context (null when SHA-NI is used)
+    uint32_t state[8];
+    uint8_t buffer[64];     // Bytes not yet compressed
+    size_t buffered;
+    uint64_t length;        // Total bytes fed so far
+
+public:
+    Sha256();
+    ~Sha256();
+    Sha256(const Sha256& other);
+    Sha256& operator=(const Sha256& other);
+
+    /**
+     * Append bytes to the message
+     */
+    Sha256& update(const void* data, size_t len);
+    Sha256& update(const std::string& str);
+
+    /**
+     * Digest of everything fed so far; the context is reset afterwards
+     */
+    Hash256 finish();
+
+    /**
+     * Start a new message
+     */
+    void reset();
+};
+
+/**
+ * Backend currently used
+ */
+Sha256Backend sha256Backend();
+
+/**
+ * Force a backend (for tests and benchmarks)
+ *
+ * @return false if the CPU does not support it (the backend is unchanged)
+ */
+bool setSha256Backend(Sha256Backend backend);
+
+/**
+ * Human-readable backend name
+ */
+const char* sha256BackendName(Sha256Backend backend);
+
+/**
+ * Round constants and initial state, shared with the multi-buffer kernels
+ */
+extern const uint32_t SHA256_K[64];
+extern const uint32_t SHA256_IV[8];
+
+/**
+ * Compress whole 64-byte blocks into state (SHA-NI when available)
+ */
+void sha256Compress(uint32_t state[8], const uint8_t* blocks, size_t count);
+
+#endif // SHA256_H
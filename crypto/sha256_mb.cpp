@@ -0,0 +1,310 @@
+#include "sha256_mb.h"
+#include "sha256.h"
+#include "../common/serialize.h"
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SHA256_MB_X86 1
+#endif
+
+namespace sha256mb {
+
+namespace {
+
+// Widest backend (AVX-512)
+const size_t MAX_LANES = 16;
+
+// Tails up to this many padded blocks are built on the stack
+const size_t STACK_BLOCKS = 4;
+
+void storeDigest(const uint32_t state[8], Hash256& out) {
+    for (int i = 0; i < 8; i++) {
+        writeBE32(out.bytes + 4 * i, state[i]);
+    }
+}
+
+// Write tail || 0x80 || zeros || 64-bit big-endian bit length into blocks * 64 bytes
+void padTail(const uint8_t* tail, size_t tailLength, uint64_t bitLength, uint8_t* out, size_t blocks) {
+    size_t size = blocks * 64;
+    std::memcpy(out, tail, tailLength);
+    out[tailLength] = 0x80;
+    std::memset(out + tailLength + 1, 0, size - tailLength - 1 - 8);
+    for (int i = 0; i < 8; i++) {
+        out[size - 1 - i] = static_cast<uint8_t>(bitLength >> (8 * i));
+    }
+}
+
+// A kernel finishes `lanes` padded messages (at most its width) from a shared midstate
+typedef void (*Kernel)(const Midstate& midstate, const uint8_t* padded, size_t stride,
+                       size_t blocks, size_t lanes, Hash256* out);
+
+void kernelScalar(const Midstate& midstate, const uint8_t* padded, size_t stride,
+                  size_t blocks, size_t lanes, Hash256* out) {
+    for (size_t lane = 0; lane < lanes; lane++) {
+        uint32_t state[8];
+        std::memcpy(state, midstate.h, sizeof(state));
+        sha256Compress(state, padded + lane * stride, blocks);
+        storeDigest(state, out[lane]);
+    }
+}
+
+#ifdef SHA256_MB_X86
+
+// Lane-parallel rounds, written once for both vector widths
+#define SHA256_MB_ROUNDS(ADD, XOR, SHR, ROTR, CH, MAJ, SET1)                                  \
+    for (int i = 0; i < 64; i++) {                                                            \
+        if (i >= 16) {                                                                        \
+            VEC w15 = w[(i - 15) & 15];                                                       \
+            VEC w2 = w[(i - 2) & 15];                                                         \
+            VEC s0 = XOR(XOR(ROTR(w15, 7), ROTR(w15, 18)), SHR(w15, 3));                      \
+            VEC s1 = XOR(XOR(ROTR(w2, 17), ROTR(w2, 19)), SHR(w2, 10));                       \
+            w[i & 15] = ADD(ADD(w[i & 15], s0), ADD(w[(i - 7) & 15], s1));                    \
+        }                                                                                     \
+        VEC S1 = XOR(XOR(ROTR(e, 6), ROTR(e, 11)), ROTR(e, 25));                              \
+        VEC t1 = ADD(ADD(ADD(h, S1), ADD(CH(e, f, g), SET1(static_cast<int>(SHA256_K[i])))), w[i & 15]); \
+        VEC S0 = XOR(XOR(ROTR(a, 2), ROTR(a, 13)), ROTR(a, 22));                              \
+        VEC t2 = ADD(S0, MAJ(a, b, c));                                                       \
+        h = g; g = f; f = e; e = ADD(d, t1);                                                  \
+        d = c; c = b; b = a; a = ADD(t1, t2);                                                 \
+    }
+
+#define AVX2_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#define AVX2_CH(e, f, g) _mm256_xor_si256(_mm256_and_si256((e), (f)), _mm256_andnot_si256((e), (g)))
+#define AVX2_MAJ(a, b, c) _mm256_or_si256(_mm256_and_si256((a), (b)), _mm256_and_si256((c), _mm256_or_si256((a), (b))))
+
+__attribute__((target("avx2")))
+void kernelAvx2(const Midstate& midstate, const uint8_t* padded, size_t stride,
+                size_t blocks, size_t lanes, Hash256* out) {
+    typedef __m256i VEC;
+    const size_t WIDTH = 8;
+
+    VEC state[8];
+    for (int i = 0; i < 8; i++) {
+        state[i] = _mm256_set1_epi32(static_cast<int>(midstate.h[i]));
+    }
+
+    alignas(32) uint32_t words[16][WIDTH];
+    for (size_t blk = 0; blk < blocks; blk++) {
+        // Transpose: word j of every lane goes into vector j
+        for (int j = 0; j < 16; j++) {
+            for (size_t lane = 0; lane < WIDTH; lane++) {
+                words[j][lane] = lane < lanes ? readBE32(padded + lane * stride + blk * 64 + 4 * j) : 0;
+            }
+        }
+        VEC w[16];
+        for (int j = 0; j < 16; j++) {
+            w[j] = _mm256_load_si256(reinterpret_cast<const VEC*>(words[j]));
+        }
+
+        VEC a = state[0], b = state[1], c = state[2], d = state[3];
+        VEC e = state[4], f = state[5], g = state[6], h = state[7];
+        SHA256_MB_ROUNDS(_mm256_add_epi32, _mm256_xor_si256, _mm256_srli_epi32, AVX2_ROTR,
+                         AVX2_CH, AVX2_MAJ, _mm256_set1_epi32)
+        state[0] = _mm256_add_epi32(state[0], a); state[1] = _mm256_add_epi32(state[1], b);
+        state[2] = _mm256_add_epi32(state[2], c); state[3] = _mm256_add_epi32(state[3], d);
+        state[4] = _mm256_add_epi32(state[4], e); state[5] = _mm256_add_epi32(state[5], f);
+        state[6] = _mm256_add_epi32(state[6], g); state[7] = _mm256_add_epi32(state[7], h);
+    }
+
+    alignas(32) uint32_t result[8][WIDTH];
+    for (int i = 0; i < 8; i++) {
+        _mm256_store_si256(reinterpret_cast<VEC*>(result[i]), state[i]);
+    }
+    for (size_t lane = 0; lane < lanes; lane++) {
+        for (int i = 0; i < 8; i++) {
+            writeBE32(out[lane].bytes + 4 * i, result[i][lane]);
+        }
+    }
+}
+
+// GCC 12 reports the intentionally undefined pass-through operand of the
+// AVX-512 intrinsics as maybe-uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+#define AVX512_ROTR(x, n) _mm512_ror_epi32((x), (n))
+#define AVX512_CH(e, f, g) _mm512_ternarylogic_epi32((e), (f), (g), 0xca)
+#define AVX512_MAJ(a, b, c) _mm512_ternarylogic_epi32((a), (b), (c), 0xe8)
+
+__attribute__((target("avx512f")))
+void kernelAvx512(const Midstate& midstate, const uint8_t* padded, size_t stride,
+                  size_t blocks, size_t lanes, Hash256* out) {
+    typedef __m512i VEC;
+    const size_t WIDTH = 16;
+
+    VEC state[8];
+    for (int i = 0; i < 8; i++) {
+        state[i] = _mm512_set1_epi32(static_cast<int>(midstate.h[i]));
+    }
+
+    alignas(64) uint32_t words[16][WIDTH];
+    for (size_t blk = 0; blk < blocks; blk++) {
+        // Transpose: word j of every lane goes into vector j
+        for (int j = 0; j < 16; j++) {
+            for (size_t lane = 0; lane < WIDTH; lane++) {
+                words[j][lane] = lane < lanes ? readBE32(padded + lane * stride + blk * 64 + 4 * j) : 0;
+            }
+        }
+        VEC w[16];
+        for (int j = 0; j < 16; j++) {
+            w[j] = _mm512_load_si512(words[j]);
+        }
+
+        VEC a = state[0], b = state[1], c = state[2], d = state[3];
+        VEC e = state[4], f = state[5], g = state[6], h = state[7];
+        SHA256_MB_ROUNDS(_mm512_add_epi32, _mm512_xor_si512, _mm512_srli_epi32, AVX512_ROTR,
+                         AVX512_CH, AVX512_MAJ, _mm512_set1_epi32)
+        state[0] = _mm512_add_epi32(state[0], a); state[1] = _mm512_add_epi32(state[1], b);
+        state[2] = _mm512_add_epi32(state[2], c); state[3] = _mm512_add_epi32(state[3], d);
+        state[4] = _mm512_add_epi32(state[4], e); state[5] = _mm512_add_epi32(state[5], f);
+        state[6] = _mm512_add_epi32(state[6], g); state[7] = _mm512_add_epi32(state[7], h);
+    }
+
+    alignas(64) uint32_t result[8][WIDTH];
+    for (int i = 0; i < 8; i++) {
+        _mm512_store_si512(result[i], state[i]);
+    }
+    for (size_t lane = 0; lane < lanes; lane++) {
+        for (int i = 0; i < 8; i++) {
+            writeBE32(out[lane].bytes + 4 * i, result[i][lane]);
+        }
+    }
+}
+
+#pragma GCC diagnostic pop
+
+#endif // SHA256_MB_X86
+
+bool cpuSupports(Backend backend) {
+    switch (backend) {
+    case SCALAR:
+        return true;
+#ifdef SHA256_MB_X86
+    case AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    case AVX512:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+Backend detectBackend() {
+    if (cpuSupports(AVX512)) return AVX512;
+    if (cpuSupports(AVX2)) return AVX2;
+    return SCALAR;
+}
+
+std::atomic<int>& currentBackend() {
+    static std::atomic<int> backend(detectBackend());
+    return backend;
+}
+
+Kernel kernelFor(Backend backend) {
+    switch (backend) {
+#ifdef SHA256_MB_X86
+    case AVX512: return kernelAvx512;
+    case AVX2: return kernelAvx2;
+#endif
+    default: return kernelScalar;
+    }
+}
+
+size_t lanesFor(Backend backend) {
+    switch (backend) {
+    case AVX512: return 16;
+    case AVX2: return 8;
+    default: return 1;
+    }
+}
+
+} // namespace
+
+Midstate absorb(const uint8_t* data, size_t size) {
+    Midstate midstate;
+    std::memcpy(midstate.h, SHA256_IV, sizeof(SHA256_IV));
+    size_t blocks = size / 64;
+    sha256Compress(midstate.h, data, blocks);
+    midstate.length = blocks * 64;
+    return midstate;
+}
+
+void finishMany(const Midstate& midstate, const uint8_t* tails, size_t stride,
+                size_t tailLength, size_t count, Hash256* out) {
+    Backend backend = activeBackend();
+    Kernel kernel = kernelFor(backend);
+    size_t width = lanesFor(backend);
+
+    // Every message has the same length, hence the same padding and block count
+    size_t blocks = (tailLength + 9 + 63) / 64;
+    size_t paddedStride = blocks * 64;
+    uint64_t bitLength = (midstate.length + tailLength) * 8;
+
+    uint8_t stackBuffer[MAX_LANES * STACK_BLOCKS * 64];
+    std::vector<uint8_t> heapBuffer;
+    uint8_t* padded = stackBuffer;
+    if (blocks > STACK_BLOCKS) {
+        heapBuffer.resize(width * paddedStride);
+        padded = heapBuffer.data();
+    }
+
+    for (size_t start = 0; start < count; start += width) {
+        size_t lanes = (count - start < width) ? count - start : width;
+        for (size_t lane = 0; lane < lanes; lane++) {
+            padTail(tails + (start + lane) * stride, tailLength, bitLength,
+                    padded + lane * paddedStride, blocks);
+        }
+        kernel(midstate, padded, paddedStride, blocks, lanes, out + start);
+    }
+}
+
+Backend activeBackend() {
+    return static_cast<Backend>(currentBackend().load(std::memory_order_relaxed));
+}
+
+size_t laneCount() {
+    return lanesFor(activeBackend());
+}
+
+bool setBackend(Backend backend) {
+    if (!cpuSupports(backend)) return false;
+    currentBackend().store(backend);
+    return true;
+}
+
+const char* backendName(Backend backend) {
+    switch (backend) {
+    case AVX512: return "AVX-512 (16 lanes)";
+    case AVX2: return "AVX2 (8 lanes)";
+    default: return "scalar";
+    }
+}
+
+NonceHasher::NonceHasher(const std::string& prefix, const std::string& suffix)
+    : suffix(suffix) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(prefix.data());
+    midstate = absorb(bytes, prefix.size());
+    prefixTail = prefix.substr(static_cast<size_t>(midstate.length));
+}
+
+void NonceHasher::hashRange(uint64_t first, size_t count, Hash256* out) const {
+    static thread_local std::vector<uint8_t> scratch;
+
+    size_t tailLength = prefixTail.size() + 8 + suffix.size();
+    scratch.resize(count * tailLength);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* tail = scratch.data() + i * tailLength;
+        std::memcpy(tail, prefixTail.data(), prefixTail.size());
+        writeLE64(tail + prefixTail.size(), first + i);
+        std::memcpy(tail + prefixTail.size() + 8, suffix.data(), suffix.size());
+    }
+    finishMany(midstate, scratch.data(), tailLength, tailLength, count, out);
+}
+
+} // namespace sha256mb
@@ -0,0 +1,133 @@
+#ifndef SHA256_MB_H
+#define SHA256_MB_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "hash256.h"
+
+/**
+ * Multi-buffer SHA-256
+ *
+ * Hashes many messages that share the same prefix (e.g. one block header
+ * with different nonces) several lanes at a time: 16 with AVX-512, 8 with
+ * AVX2, one by one otherwise (with SHA-NI when available, see sha256.h).
+ * The instruction set is picked at runtime.
+ */
+namespace sha256mb {
+
+enum Backend {
+    SCALAR,
+    AVX2,
+    AVX512
+};
+
+/**
+ * SHA-256 state after absorbing a whole number of 64-byte blocks
+ */
+struct Midstate {
+    uint32_t h[8];
+    uint64_t length;    // Bytes absorbed so far (multiple of 64)
+};
+
+/**
+ * Absorb the whole 64-byte blocks of data into a fresh SHA-256 state
+ * Trailing bytes (data size not a multiple of 64) are ignored
+ */
+Midstate absorb(const uint8_t* data, size_t size);
+
+/**
+ * Finish several messages that continue the same midstate
+ *
+ * @param midstate State shared by every message
+ * @param tails Remaining bytes of message i at tails + i * stride
+ * @param stride Distance between two tails in bytes
+ * @param tailLength Length of every tail (same for all messages)
+ * @param count Number of messages
+ * @param out Receives count digests
+ */
+void finishMany(const Midstate& midstate, const uint8_t* tails, size_t stride,
+                size_t tailLength, size_t count, Hash256* out);
+
+/**
+ * Backend currently used by finishMany
+ */
+Backend activeBackend();
+
+/**
+ * Number of messages hashed together by the active backend
+ */
+size_t laneCount();
+
+/**
+ * Force a backend (for tests and benchmarks)
+ *
+ * @return false if the CPU does not support it (the backend is unchanged)
+ */
+bool setBackend(Backend backend);
+
+/**
+ * Human-readable backend name
+ */
+const char* backendName(Backend backend);
+
+/**
+ * Hashes prefix || nonce || suffix for runs of consecutive nonces, the nonce
+ * being written as 8 little-endian bytes
+ *
+ * The whole blocks of the prefix are absorbed once; each nonce only costs
+ * the compression of its tail, shared with the other lanes of the kernel.
+ */
+class NonceHasher {
+private:
+    Midstate midstate;          // State after the whole blocks of the prefix
+    std::string prefixTail;     // Prefix bytes after the last whole block
+    std::string suffix;         // Bytes following the nonce
+
+public:
+    /**
+     * Constructor
+     *
+     * @param prefix Preimage bytes before the nonce
+     * @param suffix Preimage bytes after the nonce
+     */
+    NonceHasher(const std::string& prefix, const std::string& suffix = "");
+
+    /**
+     * Hash the nonces [first, first + count)
+     *
+     * @param out Receives count digests
+     */
+    void hashRange(uint64_t first, size_t count, Hash256* out) const;
+
+    /**
+     * Hash the nonces [begin, end) in batches until one digest is accepted
+     * (matches the NonceSearch signature of common/parallel_miner.h)
+     *
+     * @param accept Predicate bool(const Hash256&) on the digest
+     * @param nonce Receives the accepted nonce
+     * @param tried Incremented by the number of nonces hashed
+     * @return true if a digest was accepted
+     */
+    template <typename Accept>
+    bool search(uint64_t begin, uint64_t end, Accept accept, uint64_t& nonce, uint64_t& tried) const {
+        const size_t BATCH = 64;
+        Hash256 digests[BATCH];
+        for (uint64_t first = begin; first < end; first += BATCH) {
+            size_t count = (end - first < BATCH) ? static_cast<size_t>(end - first) : BATCH;
+            hashRange(first, count, digests);
+            tried += count;
+            for (size_t i = 0; i < count; i++) {
+                if (accept(digests[i])) {
+                    nonce = first + i;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace sha256mb
+
+#endif // SHA256_MB_H
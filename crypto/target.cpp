@@ -0,0 +1,177 @@
+#include "target.h"
+#include <cmath>
+
+namespace {
+
+inline uint64_t loadBE64(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// A 256-bit value with room for one word of overflow, most significant word first
+struct Wide {
+    uint64_t words[5];
+};
+
+// Divide in place by a non-zero 64-bit value
+void divide(Wide& value, uint64_t divisor) {
+    unsigned __int128 remainder = 0;
+    for (int i = 0; i < 5; i++) {
+        unsigned __int128 current = (remainder << 64) | value.words[i];
+        value.words[i] = static_cast<uint64_t>(current / divisor);
+        remainder = current % divisor;
+    }
+}
+
+} // namespace
+
+Target::Target() {
+    for (int i = 0; i < 4; i++) words[i] = 0;
+}
+
+uint8_t Target::byteAt(int i) const {
+    if (i < 0 || i >= 32) return 0;
+    return static_cast<uint8_t>(words[3 - i / 8] >> (8 * (i % 8)));
+}
+
+void Target::setByteAt(int i, uint8_t value) {
+    if (i < 0 || i >= 32) return;
+    uint64_t& word = words[3 - i / 8];
+    int shift = 8 * (i % 8);
+    word = (word & ~(static_cast<uint64_t>(0xff) << shift)) | (static_cast<uint64_t>(value) << shift);
+}
+
+constexpr uint32_t Target::MAX_COMPACT;
+
+Target Target::maximum() {
+    Target target;
+    for (int i = 0; i < 4; i++) target.words[i] = UINT64_MAX;
+    return target;
+}
+
+Target Target::fromLeadingZeroNibbles(int n) {
+    if (n <= 0) return maximum();
+    Target target;
+    if (n >= 64) return target;
+    // Set the low 256 - 4n bits
+    int ones = 256 - 4 * n;
+    for (int w = 0; w < 4; w++) {
+        int low = 64 * (3 - w);
+        if (ones >= low + 64) {
+            target.words[w] = UINT64_MAX;
+        } else if (ones > low) {
+            target.words[w] = (static_cast<uint64_t>(1) << (ones - low)) - 1;
+        }
+    }
+    return target;
+}
+
+Target Target::fromCompact(uint32_t bits) {
+    Target target;
+    int size = static_cast<int>(bits >> 24);
+    uint32_t mantissa = bits & 0x00ffffff;
+    // Negative (sign bit) or wider than 256 bits: not a usable target
+    if ((mantissa & 0x00800000) != 0 || size > 32) return target;
+    // Mantissa bytes land at positions size-1, size-2, size-3 (lower ones are dropped)
+    for (int k = 0; k < 3; k++) {
+        target.setByteAt(size - 1 - k, static_cast<uint8_t>(mantissa >> (16 - 8 * k)));
+    }
+    return target;
+}
+
+bool Target::isValidCompact(uint32_t bits) {
+    Target target = fromCompact(bits);
+    // Canonical encodings round-trip; this also rejects the invalid ones (zero target)
+    return target != Target() && target.toCompact() == bits;
+}
+
+uint32_t Target::toCompact() const {
+    int size = 32;
+    while (size > 0 && byteAt(size - 1) == 0) size--;
+    if (size == 0) return 0;
+
+    uint32_t mantissa = (static_cast<uint32_t>(byteAt(size - 1)) << 16) |
+                        (static_cast<uint32_t>(byteAt(size - 2)) << 8) |
+                        static_cast<uint32_t>(byteAt(size - 3));
+    // Keep the sign bit clear by moving to a larger exponent; at the top
+    // exponent there is none left, so clamp to the largest encodable target
+    if (mantissa & 0x00800000) {
+        if (size == 32) return MAX_COMPACT;
+        mantissa >>= 8;
+        size++;
+    }
+    return (static_cast<uint32_t>(size) << 24) | mantissa;
+}
+
+bool Target::isMetBy(const Hash256& hash) const {
+    for (int i = 0; i < 4; i++) {
+        uint64_t word = loadBE64(hash.bytes + 8 * i);
+        if (word != words[i]) return word < words[i];
+    }
+    return true;
+}
+
+Target Target::scaled(uint64_t numerator, uint64_t denominator) const {
+    if (denominator == 0) return maximum();
+    Wide product = {};
+    uint64_t carry = 0;
+    for (int i = 3; i >= 0; i--) {
+        unsigned __int128 term = static_cast<unsigned __int128>(words[i]) * numerator + carry;
+        product.words[i + 1] = static_cast<uint64_t>(term);
+        carry = static_cast<uint64_t>(term >> 64);
+    }
+    product.words[0] = carry;
+    divide(product, denominator);
+
+    if (product.words[0] != 0) return maximum();
+    Target result;
+    for (int i = 0; i < 4; i++) result.words[i] = product.words[i + 1];
+    return result;
+}
+
+Target Target::mean(const std::vector<Target>& targets) {
+    Target result;
+    if (targets.empty()) return result;
+    Wide sum = {};
+    for (const Target& target : targets) {
+        uint64_t carry = 0;
+        for (int i = 3; i >= 0; i--) {
+            unsigned __int128 term = static_cast<unsigned __int128>(sum.words[i + 1]) + target.words[i] + carry;
+            sum.words[i + 1] = static_cast<uint64_t>(term);
+            carry = static_cast<uint64_t>(term >> 64);
+        }
+        sum.words[0] += carry;
+    }
+    divide(sum, targets.size());
+    for (int i = 0; i < 4; i++) result.words[i] = sum.words[i + 1];
+    return result;
+}
+
+double Target::expectedHashes() const {
+    double value = 0;
+    for (int i = 0; i < 4; i++) {
+        value = value * 18446744073709551616.0 + static_cast<double>(words[i]);
+    }
+    return std::ldexp(1.0, 256) / (value + 1.0);
+}
+
+std::string Target::toHex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(64, '0');
+    for (int i = 0; i < 32; i++) {
+        uint8_t b = byteAt(31 - i);
+        hex[2 * i] = digits[b >> 4];
+        hex[2 * i + 1] = digits[b & 0x0f];
+    }
+    return hex;
+}
+
+bool Target::operator==(const Target& other) const {
+    for (int i = 0; i < 4; i++) {
+        if (words[i] != other.words[i]) return false;
+    }
+    return true;
+}
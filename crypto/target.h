@@ -0,0 +1,93 @@
+#ifndef TARGET_H
+#define TARGET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "hash256.h"
+
+/**
+ * 256-bit proof-of-work target
+ *
+ * A hash meets the target when, read as a big-endian 256-bit integer (the
+ * order it is displayed in), it is lower than or equal to the target.
+ * Headers store the target in the compact "nBits" form: the top byte is
+ * the size of the number in bytes, the low 3 bytes its most significant
+ * bytes (the mantissa). Unlike "number of leading hex zeros", consecutive
+ * compact values differ by far less than a factor of 16 in expected work.
+ */
+class Target {
+private:
+    uint64_t words[4];      // Most significant word first
+
+    uint8_t byteAt(int i) const;            // Byte i, counted from the least significant
+    void setByteAt(int i, uint8_t value);
+
+public:
+    /**
+     * The zero target (only the all-zero hash meets it)
+     */
+    Target();
+
+    /**
+     * The largest target (every hash meets it)
+     */
+    static Target maximum();
+
+    /**
+     * Target equivalent to "at least n leading zero hex digits": 16^(64 - n) - 1
+     */
+    static Target fromLeadingZeroNibbles(int n);
+
+    /**
+     * Decode a compact target (invalid encodings give the zero target)
+     */
+    static Target fromCompact(uint32_t bits);
+
+    /**
+     * Check that bits is a canonical, non-zero compact target
+     */
+    static bool isValidCompact(uint32_t bits);
+
+    /**
+     * Largest compact target (mantissa 0x7fffff at exponent 32), slightly
+     * below maximum(), which has no compact encoding
+     */
+    static constexpr uint32_t MAX_COMPACT = 0x207fffff;
+
+    /**
+     * Encode in compact form, rounding the mantissa down (the result is never easier)
+     * Targets above fromCompact(MAX_COMPACT) encode as MAX_COMPACT
+     */
+    uint32_t toCompact() const;
+
+    /**
+     * Check the PoW condition hash <= target, one 64-bit word at a time
+     */
+    bool isMetBy(const Hash256& hash) const;
+
+    /**
+     * target * numerator / denominator, computed exactly and capped at maximum()
+     */
+    Target scaled(uint64_t numerator, uint64_t denominator) const;
+
+    /**
+     * Arithmetic mean of several targets (rounded down; zero if empty)
+     */
+    static Target mean(const std::vector<Target>& targets);
+
+    /**
+     * Expected number of hashes to find one meeting the target: 2^256 / (target + 1)
+     */
+    double expectedHashes() const;
+
+    /**
+     * 64-character hex representation
+     */
+    std::string toHex() const;
+
+    bool operator==(const Target& other) const;
+    bool operator!=(const Target& other) const { return !(*this == other); }
+};
+
+#endif // TARGET_H
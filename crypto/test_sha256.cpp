@@ -0,0 +1,160 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+#include "sha256.h"
+#include "sha256_mb.h"
+
+// Reference digest computed with OpenSSL
+Hash256 referenceSha256(const std::string& message) {
+    Hash256 digest;
+    EVP_Digest(message.data(), message.size(), digest.bytes, nullptr, EVP_sha256(), nullptr);
+    return digest;
+}
+
+// Display test results
+void displayTestResult(const std::string& testName, bool result) {
+    std::cout << "Test " << testName << ": " << (result ? "PASSED" : "FAILED") << std::endl;
+}
+
+// Build a deterministic message of the given length
+std::string makeMessage(size_t length, unsigned seed) {
+    std::string message(length, '\0');
+    for (size_t i = 0; i < length; i++) {
+        message[i] = static_cast<char>((i * 131 + seed * 17 + 7) & 0xff);
+    }
+    return message;
+}
+
+// One-shot hashing of every length up to three blocks, plus the "abc" known answer
+bool testOneShot() {
+    if (sha256("abc").toHex() != "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad") return false;
+    for (size_t length = 0; length <= 192; length++) {
+        std::string message = makeMessage(length, 5);
+        if (sha256(message) != referenceSha256(message)) return false;
+    }
+    return true;
+}
+
+// Streaming in uneven pieces, and finishing a copied context
+bool testStreaming() {
+    std::string message = makeMessage(1000, 9);
+    for (size_t piece = 1; piece <= 130; piece += 3) {
+        Sha256 context;
+        for (size_t offset = 0; offset < message.size(); offset += piece) {
+            context.update(message.substr(offset, piece));
+        }
+        if (context.finish() != referenceSha256(message)) return false;
+    }
+
+    Sha256 prefix;
+    prefix.update(message.substr(0, 100));
+    Sha256 copy(prefix);
+    if (copy.update("first").finish() != referenceSha256(message.substr(0, 100) + "first")) return false;
+    if (prefix.update("second").finish() != referenceSha256(message.substr(0, 100) + "second")) return false;
+    // finish() resets the context
+    return prefix.update("abc").finish() == sha256("abc");
+}
+
+// Known answer: SHA-256("abc")
+bool testKnownAnswer() {
+    std::string message = "abc";
+    sha256mb::Midstate midstate = sha256mb::absorb(nullptr, 0);
+    Hash256 digest;
+    sha256mb::finishMany(midstate, reinterpret_cast<const uint8_t*>(message.data()), 3, 3, 1, &digest);
+    return digest.toHex() == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+}
+
+// Messages sharing a prefix, for every tail length up to three blocks and lane counts 1..40
+bool testFinishMany() {
+    for (size_t prefixLength = 0; prefixLength <= 192; prefixLength += 64) {
+        std::string prefix = makeMessage(prefixLength, 1);
+        sha256mb::Midstate midstate = sha256mb::absorb(reinterpret_cast<const uint8_t*>(prefix.data()), prefix.size());
+        for (size_t tailLength = 0; tailLength <= 200; tailLength += 7) {
+            size_t count = 1 + (tailLength % 40);
+            std::vector<std::string> tails;
+            std::string packed;
+            for (size_t i = 0; i < count; i++) {
+                tails.push_back(makeMessage(tailLength, static_cast<unsigned>(i + tailLength)));
+                packed += tails.back();
+            }
+            std::vector<Hash256> digests(count);
+            sha256mb::finishMany(midstate, reinterpret_cast<const uint8_t*>(packed.data()), tailLength,
+                                 tailLength, count, digests.data());
+            for (size_t i = 0; i < count; i++) {
+                if (digests[i] != referenceSha256(prefix + tails[i])) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// prefix || little-endian nonce || suffix, with prefixes ending inside and on a block boundary
+bool testNonceHasher() {
+    for (size_t prefixLength : {72, 100, 128}) {
+        std::string prefix = makeMessage(prefixLength, 3);
+        std::string suffix = "validator";
+        sha256mb::NonceHasher hasher(prefix, suffix);
+        const uint64_t first = 0xfffffffffull - 60;
+        const size_t count = 120;
+        std::vector<Hash256> digests(count);
+        hasher.hashRange(first, count, digests.data());
+        for (size_t i = 0; i < count; i++) {
+            std::string nonce(8, '\0');
+            for (int b = 0; b < 8; b++) nonce[b] = static_cast<char>((first + i) >> (8 * b));
+            if (digests[i] != referenceSha256(prefix + nonce + suffix)) return false;
+        }
+
+        // search() reports the first accepted nonce and how many were hashed
+        const Hash256 wanted = digests[77];
+        uint64_t found = 0;
+        uint64_t tried = 0;
+        bool accepted = hasher.search(first, first + count, [&wanted](const Hash256& h) { return h == wanted; }, found, tried);
+        if (!accepted || found != first + 77 || tried != count) return false;
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "===== SHA-256 TESTS =====" << std::endl << std::endl;
+
+    bool allPassed = true;
+    const Sha256Backend singleBackends[] = {SHA256_OPENSSL, SHA256_SHANI};
+    Sha256Backend singleDetected = sha256Backend();
+
+    for (Sha256Backend single : singleBackends) {
+        if (!setSha256Backend(single)) {
+            std::cout << "Skipping " << sha256BackendName(single) << " (not supported by this CPU)" << std::endl;
+            continue;
+        }
+        std::string singleName = sha256BackendName(single);
+        bool oneShot = testOneShot();
+        bool streaming = testStreaming();
+        displayTestResult("One-shot [" + singleName + "]", oneShot);
+        displayTestResult("Streaming [" + singleName + "]", streaming);
+        allPassed = allPassed && oneShot && streaming;
+
+        // The multi-buffer scalar path and prefix absorption use the single-buffer compression
+        const sha256mb::Backend backends[] = {sha256mb::SCALAR, sha256mb::AVX2, sha256mb::AVX512};
+        sha256mb::Backend detected = sha256mb::activeBackend();
+        for (sha256mb::Backend backend : backends) {
+            if (!sha256mb::setBackend(backend)) {
+                std::cout << "Skipping " << sha256mb::backendName(backend) << " (not supported by this CPU)" << std::endl;
+                continue;
+            }
+            std::string name = std::string(sha256mb::backendName(backend)) + ", " + singleName;
+            bool knownAnswer = testKnownAnswer();
+            bool finishMany = testFinishMany();
+            bool nonceHasher = testNonceHasher();
+            displayTestResult("Known answer [" + name + "]", knownAnswer);
+            displayTestResult("Multi-buffer finish [" + name + "]", finishMany);
+            displayTestResult("Nonce hasher [" + name + "]", nonceHasher);
+            allPassed = allPassed && knownAnswer && finishMany && nonceHasher;
+        }
+        sha256mb::setBackend(detected);
+    }
+    setSha256Backend(singleDetected);
+
+    std::cout << std::endl << (allPassed ? "All tests passed!" : "Some tests failed!") << std::endl;
+    return allPassed ? 0 : 1;
+}
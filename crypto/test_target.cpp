@@ -0,0 +1,136 @@
+#include <iostream>
+#include <string>
+#include <cmath>
+#include "target.h"
+#include "sha256.h"
+
+// Display test results
+void displayTestResult(const std::string& testName, bool result) {
+    std::cout << "Test " << testName << ": " << (result ? "PASSED" : "FAILED") << std::endl;
+}
+
+// Hash whose bytes spell the given target (the largest hash meeting it)
+Hash256 hashOf(const Target& target) {
+    Hash256 hash;
+    Hash256::fromHex(target.toHex(), hash);
+    return hash;
+}
+
+// Known compact value (Bitcoin's initial target)
+bool testCompactKnownValue() {
+    Target target = Target::fromCompact(0x1d00ffff);
+    return target.toHex() == "00000000ffff0000000000000000000000000000000000000000000000000000" &&
+           target.toCompact() == 0x1d00ffff;
+}
+
+// Small exponents, sign bit and oversized encodings
+bool testCompactEdgeCases() {
+    return Target::fromCompact(0x01120000).toCompact() == 0x01120000 &&
+           Target::fromCompact(0x02008000).toHex() == std::string(62, '0') + "80" &&
+           Target::fromCompact(0x02008000).toCompact() == 0x02008000 &&
+           Target::isValidCompact(0x1d00ffff) &&
+           !Target::isValidCompact(0) &&
+           !Target::isValidCompact(0x1d800000) &&   // Negative
+           !Target::isValidCompact(0x21010000) &&   // Wider than 256 bits
+           !Target::isValidCompact(0x1e0000ff) &&   // Not canonical
+           Target::fromCompact(0x1d800000) == Target();
+}
+
+// Targets too large for a compact exponent of 32 clamp to the largest valid encoding
+bool testCompactMaximum() {
+    uint32_t maximum = Target::maximum().toCompact();
+    uint32_t easiest = Target::fromLeadingZeroNibbles(0).toCompact();
+    return maximum == Target::MAX_COMPACT && easiest == Target::MAX_COMPACT &&
+           Target::isValidCompact(maximum) &&
+           Target::fromCompact(maximum).toCompact() == maximum &&
+           Target::fromCompact(maximum).isMetBy(hashOf(Target::fromCompact(maximum))) &&
+           !Target::fromCompact(maximum).isMetBy(hashOf(Target::maximum()));
+}
+
+// The nibble target accepts exactly the hashes with n leading zero hex digits
+bool testLeadingZeroNibbles() {
+    for (int n = 0; n <= 64; n++) {
+        Target target = Target::fromLeadingZeroNibbles(n);
+        for (int i = 0; i < 200; i++) {
+            Hash256 hash = sha256("nibbles" + std::to_string(n) + ":" + std::to_string(i));
+            // Clear leading digits so that both outcomes are exercised
+            int zeros = i % 66;
+            for (int d = 0; d < zeros && d < 64; d++) {
+                hash.bytes[d / 2] &= (d % 2 == 0) ? 0x0f : 0xf0;
+            }
+            if (target.isMetBy(hash) != hash.hasLeadingZeroNibbles(n)) return false;
+        }
+    }
+    return true;
+}
+
+// Boundaries of hash <= target, and compact rounding never makes a target easier
+bool testComparison() {
+    for (uint32_t bits : {0x1d00ffffu, 0x1f0fffffu, 0x2000ffffu, 0x03123456u}) {
+        Target target = Target::fromCompact(bits);
+        Hash256 equal = hashOf(target);
+        if (!target.isMetBy(equal)) return false;
+
+        // equal + 1 (big-endian increment)
+        Hash256 above = equal;
+        for (int i = Hash256::SIZE - 1; i >= 0; i--) {
+            if (++above.bytes[i] != 0) break;
+        }
+        if (target.isMetBy(above)) return false;
+    }
+    for (int n = 1; n < 64; n++) {
+        Target exact = Target::fromLeadingZeroNibbles(n);
+        Target rounded = Target::fromCompact(exact.toCompact());
+        if (!exact.isMetBy(hashOf(rounded))) return false;
+    }
+    return true;
+}
+
+// Expected work of the nibble targets is 16^n
+bool testExpectedHashes() {
+    for (int n = 0; n <= 16; n++) {
+        double expected = std::pow(16.0, n);
+        double actual = Target::fromLeadingZeroNibbles(n).expectedHashes();
+        if (std::fabs(actual - expected) > expected * 1e-9) return false;
+    }
+    return true;
+}
+
+// Exact scaling and averaging
+bool testArithmetic() {
+    Target base = Target::fromCompact(0x1d00ffff);
+    if (base.scaled(4, 1) != Target::fromCompact(0x1d03fffc)) return false;
+    if (base.scaled(1, 256) != Target::fromCompact(0x1c00ffff)) return false;
+    if (base.scaled(3, 3) != base) return false;
+    if (Target::maximum().scaled(2, 1) != Target::maximum()) return false;
+
+    // Averaging near the top of the range needs the extra overflow word:
+    // (2^256 - 1 + 2^252 - 1) / 2 = 2^255 + 2^251 - 1
+    Target average = Target::mean({Target::maximum(), Target::fromLeadingZeroNibbles(1)});
+    if (average.toHex() != "87" + std::string(62, 'f')) return false;
+
+    return Target::mean({}) == Target() && Target::mean({base}) == base;
+}
+
+int main() {
+    std::cout << "===== TARGET TESTS =====" << std::endl << std::endl;
+
+    bool knownValue = testCompactKnownValue();
+    bool edgeCases = testCompactEdgeCases();
+    bool compactMaximum = testCompactMaximum();
+    bool nibbles = testLeadingZeroNibbles();
+    bool comparison = testComparison();
+    bool expectedHashes = testExpectedHashes();
+    bool arithmetic = testArithmetic();
+    displayTestResult("Compact known value", knownValue);
+    displayTestResult("Compact edge cases", edgeCases);
+    displayTestResult("Compact maximum", compactMaximum);
+    displayTestResult("Leading zero nibbles", nibbles);
+    displayTestResult("Comparison", comparison);
+    displayTestResult("Expected hashes", expectedHashes);
+    displayTestResult("Arithmetic", arithmetic);
+
+    bool allPassed = knownValue && edgeCases && compactMaximum && nibbles && comparison && expectedHashes && arithmetic;
+    std::cout << std::endl << (allPassed ? "All tests passed!" : "Some tests failed!") << std::endl;
+    return allPassed ? 0 : 1;
+}
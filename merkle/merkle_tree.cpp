@@ -1,162 +1,471 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <sstream>
-#include <iomanip>
-#include <openssl/sha.h>
+#include <cstring>
+#include <algorithm>
 #include "merkle_tree.h"
+#include "../crypto/sha256_mb.h"
 
-// Fonction pour calculer le hash SHA-256 d'une chaîne de caractères
-inline std::string sha256(const std::string& str) {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, str.c_str(), str.size());
-    SHA256_Final(hash, &sha256);
-    
-    std::stringstream ss;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i];
+const size_t MerkleTree::PARALLEL_THRESHOLD;
+
+// Constructeur à partir d'un vecteur de données
+MerkleTree::MerkleTree(const std::vector<std::string>& data, unsigned threads) {
+    // Arbre vide : aucun niveau
+    if (data.empty()) {
+        return;
     }
-    return ss.str();
+    allocateLevels(data.size());
+
+    // Les feuilles sont le hash des données, réparties entre les threads
+    parallelFor(data.size(), PARALLEL_THRESHOLD, threads, [this, &data](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            nodes[i] = sha256(data[i]);
+        }
+    });
+
+    buildLevels(threads);
 }
 
-// Constructeur pour un nœud feuille (contenant les données de base)
-Node::Node(const std::string& data) : left(nullptr), right(nullptr) {
-    hash = sha256(data);
+// Constructeur à partir des hash des feuilles
+MerkleTree::MerkleTree(const std::vector<Hash256>& leafHashes, unsigned threads) {
+    if (leafHashes.empty()) {
+        return;
+    }
+    allocateLevels(leafHashes.size());
+    std::copy(leafHashes.begin(), leafHashes.end(), nodes.begin());
+    buildLevels(threads);
 }
 
-// Constructeur pour un nœud interne (parent de deux nœuds)
-Node::Node(Node* left, Node* right) : left(left), right(right) {
-    hash = sha256(left->hash + right->hash);
+// Taille de chaque niveau (arrondie au supérieur) puis une seule allocation
+void MerkleTree::allocateLevels(size_t leafCount) {
+    levelOffsets.push_back(0);
+    size_t count = leafCount;
+    size_t total = 0;
+    while (true) {
+        total += count;
+        levelOffsets.push_back(total);
+        if (count == 1) break;
+        count = (count + 1) / 2;
+    }
+    nodes.resize(total);
 }
 
-// Destructeur
-Node::~Node() {
-    // Add safety checks
-    if (left != right) {
-        delete left;
-        delete right;
-    } else if (left) {
-        // If left and right point to the same node (duplicated last node case),
-        // only delete one of them to avoid double free
-        delete left;
-        right = nullptr; // Prevent second deletion of the same pointer
+// Calculer chaque niveau à partir du précédent
+void MerkleTree::buildLevels(unsigned threads) {
+    for (size_t level = 0; level + 1 < levelOffsets.size() - 1; level++) {
+        const Hash256* in = &nodes[levelOffsets[level]];
+        Hash256* out = &nodes[levelOffsets[level + 1]];
+        size_t count = levelSize(level);
+
+        // Chaque thread calcule une tranche de parents ; seule la dernière
+        // tranche peut se terminer par un nœud dupliqué
+        parallelFor(levelSize(level + 1), PARALLEL_THRESHOLD, threads, [in, out, count](size_t begin, size_t end) {
+            size_t last = std::min(2 * end, count);
+            hashLevel(in + 2 * begin, last - 2 * begin, out + begin);
+        });
     }
 }
 
-// Implémentation des méthodes de la classe MerkleTree
+// Regrouper les nœuds deux par deux pour créer leurs parents
+void MerkleTree::hashLevel(const Hash256* in, size_t count, Hash256* out) {
+    static_assert(sizeof(Hash256) == Hash256::SIZE, "Hash256 doit faire exactement 32 octets");
 
-// Construire récursivement l'arbre à partir des nœuds feuilles
-Node* MerkleTree::buildTree(std::vector<Node*>& nodes) {
-    if (nodes.size() == 1) {
-        return nodes[0];
+    // Deux frères consécutifs forment déjà le message de 64 octets gauche || droite :
+    // les paires sont hachées plusieurs à la fois par le SHA-256 multi-buffer
+    // (16 avec AVX-512, 8 avec AVX2), sans copie, depuis l'état initial
+    static const sha256mb::Midstate initial = sha256mb::absorb(nullptr, 0);
+    size_t pairs = count / 2;
+    if (pairs > 0) {
+        sha256mb::finishMany(initial, in[0].bytes, 2 * Hash256::SIZE, 2 * Hash256::SIZE, pairs, out);
     }
-    
-    std::vector<Node*> parents;
-    
-    // Regrouper les nœuds deux par deux pour créer leurs parents
-    for (size_t i = 0; i < nodes.size(); i += 2) {
-        if (i + 1 < nodes.size()) {
-            parents.push_back(new Node(nodes[i], nodes[i + 1]));
-        } else {
-            // Si le nombre de nœuds est impair, dupliquer le dernier nœud
-            parents.push_back(new Node(nodes[i], nodes[i]));
+
+    // Si le nombre de nœuds est impair, dupliquer le dernier nœud
+    if (count % 2 == 1) {
+        out[pairs] = hashPair(in[count - 1], in[count - 1]);
+    }
+}
+
+// Obtenir le hash racine (hash représentant l'ensemble des données)
+Hash256 MerkleTree::getRootHash() const {
+    return nodes.empty() ? Hash256::zero() : nodes.back();
+}
+
+// Vérifier si une donnée est présente dans les feuilles
+bool MerkleTree::verify(const std::string& data) const {
+    size_t index = 0;
+    return findLeaf(data, index);
+}
+
+// Chercher la feuille dans l'index, ou à défaut parcourir les feuilles sans copie
+bool MerkleTree::findLeaf(const std::string& data, size_t& index) const {
+    Hash256 dataHash = sha256(data);
+
+    if (hasLeafIndex()) {
+        const size_t mask = leafSlots.size() - 1;
+        for (size_t slot = homeSlot(dataHash); leafSlots[slot] != UINT32_MAX; slot = (slot + 1) & mask) {
+            if (nodes[leafSlots[slot]] == dataHash) {
+                index = leafSlots[slot];
+                return true;
+            }
         }
+        return false;
     }
-    
-    // Appel récursif pour continuer à construire les niveaux supérieurs de l'arbre
-    return buildTree(parents);
+
+    for (size_t i = 0; i < getLeafCount(); i++) {
+        if (nodes[i] == dataHash) {
+            index = i;
+            return true;
+        }
+    }
+    return false;
 }
 
-// Constructeur à partir d'un vecteur de données
-MerkleTree::MerkleTree(const std::vector<std::string>& data) {
-    // Créer les nœuds feuilles
-    std::vector<Node*> leaves;
-    for (const auto& item : data) {
-        leaves.push_back(new Node(item));
+// Chemin d'audit d'une feuille désignée par son contenu
+bool MerkleTree::getProofFor(const std::string& data, MerkleProof& proof) const {
+    size_t index = 0;
+    return findLeaf(data, index) && getProof(index, proof);
+}
+
+// Table d'au moins deux cases par feuille (puissance de deux), sondage linéaire
+bool MerkleTree::buildLeafIndex() {
+    if (getLeafCount() >= UINT32_MAX / 2) {
+        return false;
     }
-    
-    // Vérifier si la liste des données est vide
-    if (leaves.empty()) {
-        root = nullptr;
-    } else {
-        // Construire l'arbre
-        root = buildTree(leaves);
+
+    size_t capacity = 1;
+    while (capacity < 2 * getLeafCount()) {
+        capacity *= 2;
     }
+    leafSlots.assign(capacity, UINT32_MAX);
+    for (size_t i = 0; i < getLeafCount(); i++) {
+        indexLeaf(i);
+    }
+    return true;
 }
 
-// Destructeur
-MerkleTree::~MerkleTree() {
-    delete root;
+// Les hash SHA-256 sont uniformes : leurs premiers octets suffisent comme clé
+size_t MerkleTree::homeSlot(const Hash256& leafHash) const {
+    uint64_t key = 0;
+    std::memcpy(&key, leafHash.bytes, sizeof(key));
+    return static_cast<size_t>(key) & (leafSlots.size() - 1);
 }
 
-// Obtenir le hash racine (hash représentant l'ensemble des données)
-std::string MerkleTree::getRootHash() const {
-    return root ? root->hash : "";
+// Placer la position dans la première case libre
+void MerkleTree::indexLeaf(size_t index) {
+    if (!hasLeafIndex()) return;
+    const size_t mask = leafSlots.size() - 1;
+    size_t slot = homeSlot(nodes[index]);
+    while (leafSlots[slot] != UINT32_MAX) {
+        slot = (slot + 1) & mask;
+    }
+    leafSlots[slot] = static_cast<uint32_t>(index);
 }
 
-// Vérifier si une donnée est présente dans l'arbre
-bool MerkleTree::verify(const std::string& data) const {
-    if (!root) return false;
-    return verifyInLeaves(data);
+// Retirer la position (à appeler avant de modifier la feuille) en recompactant
+// la suite de cases pour que les recherches ne s'arrêtent pas sur un trou
+void MerkleTree::unindexLeaf(size_t index) {
+    if (!hasLeafIndex()) return;
+    const size_t mask = leafSlots.size() - 1;
+    size_t hole = homeSlot(nodes[index]);
+    while (leafSlots[hole] != index) {
+        hole = (hole + 1) & mask;
+    }
+
+    for (size_t slot = (hole + 1) & mask; leafSlots[slot] != UINT32_MAX; slot = (slot + 1) & mask) {
+        // Une entrée peut combler le trou si sa case de départ n'est pas entre le trou et elle
+        size_t home = homeSlot(nodes[leafSlots[slot]]);
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            leafSlots[hole] = leafSlots[slot];
+            hole = slot;
+        }
+    }
+    leafSlots[hole] = UINT32_MAX;
 }
 
-// Vérifier si une donnée est présente dans les feuilles
-bool MerkleTree::verifyInLeaves(const std::string& data) const {
-    // Recréer le hash de la donnée
-    std::string dataHash = sha256(data);
-    
-    // Récupérer tous les hash des feuilles
-    std::vector<std::string> leaves = getAllLeafHashes();
-    
-    // Comparer avec les hash des feuilles
-    for (const auto& leaf : leaves) {
-        if (leaf == dataHash) {
-            return true;
+// Recalculer un parent (le dernier nœud d'un niveau impair est apparié avec lui-même)
+void MerkleTree::rehashParent(size_t level, size_t parent) {
+    const Hash256* children = &nodes[levelOffsets[level]];
+    size_t left = 2 * parent;
+    size_t right = (left + 1 < levelSize(level)) ? left + 1 : left;
+    nodes[levelOffsets[level + 1] + parent] = hashPair(children[left], children[right]);
+}
+
+// Mettre à jour une feuille puis ses ancêtres
+bool MerkleTree::update(size_t index, const std::string& data) {
+    if (index >= getLeafCount()) {
+        return false;
+    }
+
+    unindexLeaf(index);
+    nodes[index] = sha256(data);
+    indexLeaf(index);
+    for (size_t level = 0; level + 2 < levelOffsets.size(); level++) {
+        index /= 2;
+        rehashParent(level, index);
+    }
+    return true;
+}
+
+// Mettre à jour plusieurs feuilles, niveau par niveau
+bool MerkleTree::update(const std::vector<std::pair<size_t, std::string>>& changes) {
+    for (const auto& change : changes) {
+        if (change.first >= getLeafCount()) {
+            return false;
         }
     }
-    
-    return false;
+
+    // Une position répétée garde sa dernière donnée
+    std::vector<size_t> dirty;
+    for (const auto& change : changes) {
+        unindexLeaf(change.first);
+        nodes[change.first] = sha256(change.second);
+        indexLeaf(change.first);
+        dirty.push_back(change.first);
+    }
+
+    for (size_t level = 0; level + 2 < levelOffsets.size(); level++) {
+        // Les nœuds modifiés d'un même parent ne le recalculent qu'une fois
+        for (auto& index : dirty) {
+            index /= 2;
+        }
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        for (size_t parent : dirty) {
+            rehashParent(level, parent);
+        }
+    }
+    return true;
 }
 
 // Récupérer tous les hash des feuilles
-std::vector<std::string> MerkleTree::getAllLeafHashes() const {
-    std::vector<std::string> result;
-    if (root) {
-        collectLeafHashes(root, result);
+std::vector<Hash256> MerkleTree::getAllLeafHashes() const {
+    return std::vector<Hash256>(nodes.begin(), nodes.begin() + getLeafCount());
+}
+
+// Collecter le frère de la feuille à chaque niveau
+bool MerkleTree::getProof(size_t index, MerkleProof& proof) const {
+    if (index >= getLeafCount()) {
+        return false;
+    }
+
+    proof.index = index;
+    proof.siblings.clear();
+    for (size_t level = 0; level + 2 < levelOffsets.size(); level++) {
+        // Le dernier nœud d'un niveau impair est son propre frère
+        size_t sibling = index ^ 1;
+        if (sibling >= levelSize(level)) sibling = index;
+        proof.siblings.push_back(nodes[levelOffsets[level] + sibling]);
+        index /= 2;
     }
-    return result;
+    return true;
 }
 
-// Collecter récursivement les hash des feuilles
-void MerkleTree::collectLeafHashes(const Node* node, std::vector<std::string>& hashes) const {
-    if (!node) return;
-    
-    // Si c'est une feuille (pas de fils)
-    if (!node->left && !node->right) {
-        hashes.push_back(node->hash);
-    } else {
-        // Continuer la recherche récursive
-        collectLeafHashes(node->left, hashes);
-        collectLeafHashes(node->right, hashes);
+// Remonter le chemin : le bit de poids faible de l'index donne le côté du nœud
+Hash256 MerkleTree::rootFromProof(const Hash256& leafHash, const MerkleProof& proof) {
+    Hash256 hash = leafHash;
+    size_t index = proof.index;
+    for (const auto& sibling : proof.siblings) {
+        hash = (index & 1) ? hashPair(sibling, hash) : hashPair(hash, sibling);
+        index /= 2;
+    }
+    return hash;
+}
+
+// Vérification sans état : seul le hash racine est nécessaire
+bool MerkleTree::verifyProof(const std::string& data, const MerkleProof& proof, const Hash256& root) {
+    return rootFromProof(sha256(data), proof) == root;
+}
+
+// Parcourir les niveaux en ne gardant que les nœuds connus ; un frère absent
+// de la liste (et distinct du nœud) est pris dans l'arbre et ajouté à la preuve
+bool MerkleTree::getMultiProof(const std::vector<size_t>& indices, MerkleMultiProof& proof) const {
+    std::vector<size_t> current(indices);
+    std::sort(current.begin(), current.end());
+    current.erase(std::unique(current.begin(), current.end()), current.end());
+    if (current.empty() || current.back() >= getLeafCount()) {
+        return false;
+    }
+
+    proof.leafCount = getLeafCount();
+    proof.indices = current;
+    proof.hashes.clear();
+    for (size_t level = 0; level + 2 < levelOffsets.size(); level++) {
+        const Hash256* levelNodes = &nodes[levelOffsets[level]];
+        std::vector<size_t> parents;
+        for (size_t k = 0; k < current.size(); k++) {
+            size_t index = current[k];
+            if (index % 2 == 1) {
+                // Nœud droit : son frère gauche aurait été traité juste avant
+                proof.hashes.push_back(levelNodes[index - 1]);
+            } else if (k + 1 < current.size() && current[k + 1] == index + 1) {
+                k++;
+            } else if (index + 1 < levelSize(level)) {
+                proof.hashes.push_back(levelNodes[index + 1]);
+            }
+            parents.push_back(index / 2);
+        }
+        current.swap(parents);
+    }
+    return true;
+}
+
+// Même parcours que getMultiProof, en recalculant chaque nœud connu une seule fois
+bool MerkleTree::rootFromMultiProof(const std::vector<Hash256>& leafHashes, const MerkleMultiProof& proof, Hash256& root) {
+    if (proof.indices.empty() || leafHashes.size() != proof.indices.size()) {
+        return false;
+    }
+    for (size_t k = 0; k < proof.indices.size(); k++) {
+        if (proof.indices[k] >= proof.leafCount || (k > 0 && proof.indices[k] <= proof.indices[k - 1])) {
+            return false;
+        }
+    }
+
+    std::vector<size_t> current(proof.indices);
+    std::vector<Hash256> hashes(leafHashes);
+    size_t used = 0;
+    for (size_t size = proof.leafCount; size > 1; size = (size + 1) / 2) {
+        std::vector<size_t> parents;
+        std::vector<Hash256> parentHashes;
+        for (size_t k = 0; k < current.size(); k++) {
+            size_t index = current[k];
+            Hash256 parent;
+            if (index % 2 == 1) {
+                if (used == proof.hashes.size()) return false;
+                parent = hashPair(proof.hashes[used++], hashes[k]);
+            } else if (k + 1 < current.size() && current[k + 1] == index + 1) {
+                parent = hashPair(hashes[k], hashes[k + 1]);
+                k++;
+            } else if (index + 1 < size) {
+                if (used == proof.hashes.size()) return false;
+                parent = hashPair(hashes[k], proof.hashes[used++]);
+            } else {
+                // Dernier nœud d'un niveau impair : apparié avec lui-même
+                parent = hashPair(hashes[k], hashes[k]);
+            }
+            parents.push_back(index / 2);
+            parentHashes.push_back(parent);
+        }
+        current.swap(parents);
+        hashes.swap(parentHashes);
     }
+
+    // Tous les frères fournis doivent avoir servi
+    if (used != proof.hashes.size()) {
+        return false;
+    }
+    root = hashes[0];
+    return true;
+}
+
+// Vérification groupée sans état : seul le hash racine est nécessaire
+bool MerkleTree::verifyMultiProof(const std::vector<std::string>& data, const MerkleMultiProof& proof, const Hash256& root) {
+    std::vector<Hash256> leafHashes;
+    leafHashes.reserve(data.size());
+    for (const auto& item : data) {
+        leafHashes.push_back(sha256(item));
+    }
+    Hash256 computed;
+    return rootFromMultiProof(leafHashes, proof, computed) && computed == root;
+}
+
+// Concaténer les deux empreintes brutes (64 octets) puis hacher
+Hash256 MerkleTree::hashPair(const Hash256& left, const Hash256& right) {
+    unsigned char buffer[2 * Hash256::SIZE];
+    std::memcpy(buffer, left.bytes, Hash256::SIZE);
+    std::memcpy(buffer + Hash256::SIZE, right.bytes, Hash256::SIZE);
+    return sha256(buffer, sizeof(buffer));
+}
+
+// Collecter les frères du chemin le plus à gauche, du bas vers le haut
+std::vector<Hash256> MerkleTree::getLeftmostBranch() const {
+    // Sous la racine, chaque niveau a au moins deux nœuds : le frère du
+    // premier nœud est toujours le second
+    std::vector<Hash256> branch;
+    for (size_t level = 0; level + 2 < levelOffsets.size(); level++) {
+        branch.push_back(nodes[levelOffsets[level] + 1]);
+    }
+    return branch;
+}
+
+// Remonter de la première feuille jusqu'à la racine
+Hash256 MerkleTree::rootFromLeftmostBranch(const Hash256& leafHash, const std::vector<Hash256>& branch) {
+    Hash256 hash = leafHash;
+    for (const auto& sibling : branch) {
+        hash = hashPair(hash, sibling);
+    }
+    return hash;
 }
 
 // Afficher l'arbre pour le débogage
 void MerkleTree::printTree() const {
-    printNode(root, 0);
+    if (nodes.empty()) return;
+    printNode(levelOffsets.size() - 2, 0, 0);
 }
 
-// Afficher un nœud et ses enfants
-void MerkleTree::printNode(const Node* node, int depth) const {
-    if (!node) return;
-    
+// Afficher un nœud et ses enfants (le dernier nœud d'un niveau impair apparaît deux fois)
+void MerkleTree::printNode(size_t level, size_t index, int depth) const {
     std::string indent(depth * 4, ' ');
-    std::cout << indent << "Hash: " << node->hash.substr(0, 10) << "..." << std::endl;
-    
-    if (node->left || node->right) {
-        if (node->left) printNode(node->left, depth + 1);
-        if (node->right) printNode(node->right, depth + 1);
+    std::cout << indent << "Hash: " << nodes[levelOffsets[level] + index].toHex().substr(0, 10) << "..." << std::endl;
+
+    if (level > 0) {
+        size_t left = 2 * index;
+        size_t right = (left + 1 < levelSize(level - 1)) ? left + 1 : left;
+        printNode(level - 1, left, depth + 1);
+        printNode(level - 1, right, depth + 1);
     }
-}
\ No newline at end of file
+}
+
+// Ajouter une donnée à l'accumulateur
+void MerkleAccumulator::add(const std::string& data) {
+    addLeafHash(sha256(data));
+}
+
+// Propager la retenue : deux pics de même hauteur fusionnent en un pic plus haut
+void MerkleAccumulator::addLeafHash(const Hash256& leafHash) {
+    Hash256 carry = leafHash;
+    size_t height = 0;
+    while (leafCount & (static_cast<size_t>(1) << height)) {
+        carry = MerkleTree::hashPair(peaks[height], carry);
+        height++;
+    }
+    if (height == peaks.size()) {
+        peaks.push_back(carry);
+    } else {
+        peaks[height] = carry;
+    }
+    leafCount++;
+}
+
+// Remonter le bord droit de l'arbre à partir du plus petit pic
+Hash256 MerkleAccumulator::getRootHash() const {
+    if (leafCount == 0) {
+        return Hash256::zero();
+    }
+
+    // Le plus petit pic est le dernier nœud de son niveau
+    size_t height = 0;
+    while (!(leafCount & (static_cast<size_t>(1) << height))) {
+        height++;
+    }
+    Hash256 last = peaks[height];
+    size_t count = (leafCount >> height);  // Nœuds du niveau (le dernier est complet)
+
+    while (count > 1) {
+        if (count % 2 == 1) {
+            // Niveau impair : le dernier nœud est apparié avec lui-même
+            last = MerkleTree::hashPair(last, last);
+        } else {
+            // Son frère gauche est un sous-arbre complet, donc un pic
+            last = MerkleTree::hashPair(peaks[height], last);
+        }
+        height++;
+        count = (count + 1) / 2;
+    }
+    return last;
+}
+
+// Repartir d'un accumulateur vide
+void MerkleAccumulator::clear() {
+    peaks.clear();
+    leafCount = 0;
+}
@@ -1,64 +1,172 @@
 #ifndef MERKLE_TREE_H
 #define MERKLE_TREE_H
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
+#include "../crypto/hash256.h"
+#include "../crypto/sha256.h"
+#include "../common/parallel_for.h"
 
-// Classe représentant un nœud dans l'arbre de Merkle
-class Node {
-public:
-    std::string hash;
-    Node* left;
-    Node* right;
-    
-    // Constructeur pour un nœud feuille
-    Node(const std::string& data);
-    
-    // Constructeur pour un nœud interne
-    Node(Node* left, Node* right);
-    
-    // Destructeur
-    ~Node();
+// Chemin d'audit d'une feuille : de quoi recalculer la racine avec log2(n) hachages
+struct MerkleProof {
+    size_t index;                   // Position de la feuille
+    std::vector<Hash256> siblings;  // Frère à chaque niveau, de la feuille vers la racine
+
+    MerkleProof() : index(0) {}
+};
+
+// Preuve groupée pour plusieurs feuilles : chaque nœud interne commun n'est
+// calculé qu'une fois et seuls les frères qui ne se déduisent pas des feuilles
+// prouvées sont transmis
+struct MerkleMultiProof {
+    size_t leafCount;               // Nombre de feuilles de l'arbre (donne la forme des niveaux)
+    std::vector<size_t> indices;    // Positions des feuilles prouvées, triées
+    std::vector<Hash256> hashes;    // Frères manquants, niveau par niveau puis de gauche à droite
+
+    MerkleMultiProof() : leafCount(0) {}
 };
 
 // Classe représentant l'arbre de Merkle
+//
+// Les nœuds sont stockés niveau par niveau dans un seul tableau contigu :
+// les feuilles d'abord, puis chaque niveau de parents, la racine en dernier.
+// Le nœud i d'un niveau a pour enfants les nœuds 2i et 2i + 1 du niveau
+// inférieur ; si ce niveau est impair, le dernier nœud est apparié avec lui-même.
 class MerkleTree {
 private:
-    Node* root;
-    
-    // Construire l'arbre à partir des nœuds feuilles
-    Node* buildTree(std::vector<Node*>& nodes);
-    
-    // Vérifier si un hash est dans l'arbre
-    bool verifyInLeaves(const std::string& data) const;
-    
-    // Collecter les hash des feuilles
-    void collectLeafHashes(const Node* node, std::vector<std::string>& hashes) const;
-    
+    std::vector<Hash256> nodes;         // Tous les niveaux à la suite
+    std::vector<size_t> levelOffsets;   // Début de chaque niveau dans nodes (+ fin du tableau)
+    std::vector<uint32_t> leafSlots;    // Index optionnel : table à adressage ouvert de positions de feuilles
+
+    // Réserver tous les niveaux pour leafCount feuilles (une seule allocation)
+    void allocateLevels(size_t leafCount);
+
+    // Calculer les niveaux au-dessus des feuilles
+    void buildLevels(unsigned threads);
+
+    // Nombre de nœuds d'un niveau
+    size_t levelSize(size_t level) const { return levelOffsets[level + 1] - levelOffsets[level]; }
+
+    // Hacher un niveau entier : out[i] = hashPair(in[2i], in[2i + 1])
+    static void hashLevel(const Hash256* in, size_t count, Hash256* out);
+
+    // Case de départ d'un hash de feuille dans leafSlots
+    size_t homeSlot(const Hash256& leafHash) const;
+
+    // Ajouter / retirer la feuille index de l'index (s'il existe)
+    void indexLeaf(size_t index);
+    void unindexLeaf(size_t index);
+
+    // Recalculer le nœud parent du niveau level + 1 à partir de ses enfants
+    void rehashParent(size_t level, size_t parent);
+
+    // Afficher un nœud et ses enfants
+    void printNode(size_t level, size_t index, int depth) const;
+
 public:
-    // Constructeur
-    MerkleTree(const std::vector<std::string>& data);
-    
-    // Destructeur
-    ~MerkleTree();
-    
-    // Obtenir le hash racine
-    std::string getRootHash() const;
-    
+    // En dessous de ce nombre de hachages par thread, un niveau est calculé en série
+    static const size_t PARALLEL_THRESHOLD = 2048;
+
+    // Constructeur (threads = 0 : un par cœur ; le résultat ne dépend pas du nombre de threads)
+    MerkleTree(const std::vector<std::string>& data, unsigned threads = 0);
+
+    // Constructeur à partir des feuilles déjà hachées (l'appelant choisit leur sérialisation)
+    MerkleTree(const std::vector<Hash256>& leafHashes, unsigned threads = 0);
+
+    // Obtenir le hash racine (hash nul si l'arbre est vide)
+    Hash256 getRootHash() const;
+
     // Vérifier si une donnée est dans l'arbre
     bool verify(const std::string& data) const;
-    
+
+    // Construire l'index des feuilles : verify, findLeaf et getProofFor passent
+    // alors de O(n) à O(1) en moyenne (false si l'arbre a trop de feuilles)
+    bool buildLeafIndex();
+
+    // Savoir si l'index des feuilles est construit
+    bool hasLeafIndex() const { return !leafSlots.empty(); }
+
+    // Trouver une position de feuille contenant la donnée
+    bool findLeaf(const std::string& data, size_t& index) const;
+
+    // Chemin d'audit d'une feuille désignée par son contenu
+    bool getProofFor(const std::string& data, MerkleProof& proof) const;
+
+    // Remplacer la donnée d'une feuille : seul le chemin vers la racine est recalculé
+    // (false si index est hors de l'arbre, qui n'est alors pas modifié)
+    bool update(size_t index, const std::string& data);
+
+    // Remplacer plusieurs feuilles (position, donnée) ; un ancêtre commun n'est recalculé
+    // qu'une fois (false si une position est hors de l'arbre, qui n'est alors pas modifié)
+    bool update(const std::vector<std::pair<size_t, std::string>>& changes);
+
     // Récupérer tous les hash des feuilles
-    std::vector<std::string> getAllLeafHashes() const;
-    
+    std::vector<Hash256> getAllLeafHashes() const;
+
+    // Nombre de feuilles
+    size_t getLeafCount() const { return levelOffsets.empty() ? 0 : levelSize(0); }
+
+    // Chemin d'audit de la feuille index (false si index est hors de l'arbre)
+    bool getProof(size_t index, MerkleProof& proof) const;
+
+    // Racine obtenue en remontant le chemin d'audit depuis le hash de la feuille
+    static Hash256 rootFromProof(const Hash256& leafHash, const MerkleProof& proof);
+
+    // Vérifier sans l'arbre qu'une donnée est dans le bloc dont la racine est root
+    static bool verifyProof(const std::string& data, const MerkleProof& proof, const Hash256& root);
+
+    // Preuve groupée des feuilles indices (false si une position est hors de l'arbre ou si la liste est vide)
+    bool getMultiProof(const std::vector<size_t>& indices, MerkleMultiProof& proof) const;
+
+    // Racine obtenue à partir des hash des feuilles prouvées, dans l'ordre de proof.indices
+    // (false si la preuve est mal formée)
+    static bool rootFromMultiProof(const std::vector<Hash256>& leafHashes, const MerkleMultiProof& proof, Hash256& root);
+
+    // Vérifier sans l'arbre que les données (dans l'ordre de proof.indices) sont dans le bloc
+    static bool verifyMultiProof(const std::vector<std::string>& data, const MerkleMultiProof& proof, const Hash256& root);
+
+    // Frères du chemin de la première feuille, de la feuille vers la racine
+    std::vector<Hash256> getLeftmostBranch() const;
+
+    // Racine obtenue en remplaçant la première feuille (log n hachages au lieu de n)
+    static Hash256 rootFromLeftmostBranch(const Hash256& leafHash, const std::vector<Hash256>& branch);
+
+    // Hash d'un nœud interne : SHA-256(gauche || droite)
+    static Hash256 hashPair(const Hash256& left, const Hash256& right);
+
     // Afficher l'arbre
     void printTree() const;
-    
-    // Afficher un nœud et ses enfants
-    void printNode(const Node* node, int depth) const;
 };
 
-// Fonction utilitaire pour calculer le hash SHA-256
-std::string sha256(const std::string& str);
+// Accumulateur incrémental : ajoute les feuilles une à une en O(log n) et
+// donne la même racine qu'un MerkleTree construit sur toutes les feuilles
+//
+// Seule la frontière est gardée : la racine de chaque sous-arbre complet
+// (pic), à la manière d'un compteur binaire sur le nombre de feuilles.
+class MerkleAccumulator {
+private:
+    std::vector<Hash256> peaks;  // peaks[h] : sous-arbre de 2^h feuilles (valide si le bit h de leafCount vaut 1)
+    size_t leafCount;
+
+public:
+    MerkleAccumulator() : leafCount(0) {}
+
+    // Ajouter une donnée (hachée comme une feuille de MerkleTree)
+    void add(const std::string& data);
+
+    // Ajouter une feuille déjà hachée
+    void addLeafHash(const Hash256& leafHash);
+
+    // Racine des feuilles ajoutées (hash nul s'il n'y en a aucune)
+    Hash256 getRootHash() const;
+
+    // Nombre de feuilles ajoutées
+    size_t getLeafCount() const { return leafCount; }
+
+    // Repartir d'un accumulateur vide
+    void clear();
+};
 
-#endif // MERKLE_TREE_H
\ No newline at end of file
+#endif // MERKLE_TREE_H
@@ -14,7 +14,7 @@ int main() {
             MerkleTree tree(data);
             
             std::cout << "Root hash (even): ";
-            std::cout << tree.getRootHash().substr(0, 16) << "..." << std::endl;
+            std::cout << tree.getRootHash().toHex().substr(0, 16) << "..." << std::endl;
             
             // Tree will be destroyed here when exiting the scope
         }
@@ -27,7 +27,7 @@ int main() {
             MerkleTree tree(data);
             
             std::cout << "Root hash (odd): ";
-            std::cout << tree.getRootHash().substr(0, 16) << "..." << std::endl;
+            std::cout << tree.getRootHash().toHex().substr(0, 16) << "..." << std::endl;
             
             // Tree will be destroyed here when exiting the scope
         }
@@ -42,7 +42,7 @@ int main() {
             MerkleTree tree(data);
             
             std::cout << "Minimal root hash: ";
-            std::cout << tree.getRootHash().substr(0, 16) << "..." << std::endl;
+            std::cout << tree.getRootHash().toHex().substr(0, 16) << "..." << std::endl;
         }
         std::cout << "Minimal tree destroyed successfully" << std::endl;
         
@@ -52,8 +52,8 @@ int main() {
             std::vector<std::string> data;
             MerkleTree tree(data);
             
-            std::cout << "Empty root hash: \"";
-            std::cout << tree.getRootHash() << "\"" << std::endl;
+            std::cout << "Empty root hash is zero: ";
+            std::cout << (tree.getRootHash().isZero() ? "yes" : "no") << std::endl;
         }
         std::cout << "Empty tree destroyed successfully" << std::endl;
         
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include "sparse_merkle_tree.h"
+#include "merkle_tree.h"
+
+const size_t SparseMerkleTree::DEPTH;
+
+// Bit de la clé qui choisit le côté à la profondeur depth (0 = sous la racine)
+static bool bitAt(const Hash256& key, size_t depth) {
+    return (key.bytes[depth / 8] >> (7 - depth % 8)) & 1;
+}
+
+// Copie de la clé dont le bit de profondeur depth vaut value
+static Hash256 withBit(const Hash256& key, size_t depth, bool value) {
+    Hash256 result = key;
+    uint8_t mask = static_cast<uint8_t>(0x80 >> (depth % 8));
+    if (value) {
+        result.bytes[depth / 8] |= mask;
+    } else {
+        result.bytes[depth / 8] &= static_cast<uint8_t>(~mask);
+    }
+    return result;
+}
+
+// Parent de hauteur height + 1 ; deux sous-arbres vides donnent un sous-arbre vide sans hachage
+static Hash256 parentHash(size_t height, const Hash256& left, const Hash256& right) {
+    const Hash256& empty = SparseMerkleTree::emptyHash(height);
+    if (left == empty && right == empty) {
+        return SparseMerkleTree::emptyHash(height + 1);
+    }
+    return MerkleTree::hashPair(left, right);
+}
+
+SparseMerkleTree::SparseMerkleTree() : levels(DEPTH + 1) {}
+
+// Les hash des sous-arbres vides ne dépendent que de la hauteur : calculés une seule fois
+const Hash256& SparseMerkleTree::emptyHash(size_t height) {
+    static const std::vector<Hash256> empty = []() {
+        std::vector<Hash256> hashes(DEPTH + 1, Hash256::zero());
+        for (size_t h = 0; h < DEPTH; h++) {
+            hashes[h + 1] = MerkleTree::hashPair(hashes[h], hashes[h]);
+        }
+        return hashes;
+    }();
+    return empty[height];
+}
+
+Hash256 SparseMerkleTree::node(size_t height, const Hash256& prefix, const std::vector<Level>& changed) const {
+    if (!changed.empty()) {
+        Level::const_iterator it = changed[height].find(prefix);
+        if (it != changed[height].end()) return it->second;
+    }
+    Level::const_iterator it = levels[height].find(prefix);
+    return it != levels[height].end() ? it->second : emptyHash(height);
+}
+
+Hash256 SparseMerkleTree::getRootHash() const {
+    return node(DEPTH, Hash256::zero(), std::vector<Level>());
+}
+
+bool SparseMerkleTree::get(const Hash256& key, Hash256& value) const {
+    Level::const_iterator it = levels[0].find(key);
+    if (it == levels[0].end()) return false;
+    value = it->second;
+    return true;
+}
+
+// Remonter niveau par niveau : les préfixes triés des nœuds modifiés donnent
+// ceux de leurs parents, dont les doublons (ancêtres communs) sont voisins
+void SparseMerkleTree::rehash(const std::vector<std::pair<Hash256, Hash256>>& changes, std::vector<Level>& changed) const {
+    changed.assign(DEPTH + 1, Level());
+    std::vector<Hash256> dirty;
+    dirty.reserve(changes.size());
+    for (const auto& change : changes) {
+        changed[0][change.first] = change.second;
+        dirty.push_back(change.first);
+    }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    std::vector<Hash256> parents;
+    for (size_t h = 0; h < DEPTH; h++) {
+        // Bit qui sépare les deux enfants d'un nœud de hauteur h + 1
+        size_t depth = DEPTH - 1 - h;
+        parents.clear();
+        for (const Hash256& prefix : dirty) {
+            Hash256 parent = withBit(prefix, depth, false);
+            if (parents.empty() || parents.back() != parent) {
+                parents.push_back(parent);
+            }
+        }
+        for (const Hash256& parent : parents) {
+            Hash256 left = node(h, parent, changed);
+            Hash256 right = node(h, withBit(parent, depth, true), changed);
+            changed[h + 1][parent] = parentHash(h, left, right);
+        }
+        dirty.swap(parents);
+    }
+}
+
+void SparseMerkleTree::update(const Hash256& key, const Hash256& value) {
+    update(std::vector<std::pair<Hash256, Hash256>>(1, std::make_pair(key, value)));
+}
+
+void SparseMerkleTree::update(const std::vector<std::pair<Hash256, Hash256>>& changes) {
+    std::vector<Level> changed;
+    rehash(changes, changed);
+
+    // Seuls les nœuds non vides sont gardés
+    for (size_t h = 0; h <= DEPTH; h++) {
+        for (const auto& entry : changed[h]) {
+            if (entry.second == emptyHash(h)) {
+                levels[h].erase(entry.first);
+            } else {
+                levels[h][entry.first] = entry.second;
+            }
+        }
+    }
+}
+
+Hash256 SparseMerkleTree::rootAfter(const std::vector<std::pair<Hash256, Hash256>>& changes) const {
+    if (changes.empty()) return getRootHash();
+    std::vector<Level> changed;
+    rehash(changes, changed);
+    return node(DEPTH, Hash256::zero(), changed);
+}
+
+// Frère à chaque hauteur, de la feuille vers la racine ; les sous-arbres vides sont omis
+SparseMerkleProof SparseMerkleTree::getProof(const Hash256& key) const {
+    SparseMerkleProof proof;
+    Hash256 prefix = key;
+    for (size_t h = 0; h < DEPTH; h++) {
+        size_t depth = DEPTH - 1 - h;
+        Level::const_iterator it = levels[h].find(withBit(prefix, depth, !bitAt(prefix, depth)));
+        if (it != levels[h].end()) {
+            proof.present.set(h);
+            proof.siblings.push_back(it->second);
+        }
+        prefix = withBit(prefix, depth, false);
+    }
+    return proof;
+}
+
+bool SparseMerkleTree::rootFromProof(const Hash256& key, const Hash256& value, const SparseMerkleProof& proof, Hash256& root) {
+    Hash256 hash = value;
+    size_t used = 0;
+    for (size_t h = 0; h < DEPTH; h++) {
+        Hash256 sibling = emptyHash(h);
+        if (proof.present.test(h)) {
+            if (used == proof.siblings.size()) return false;
+            sibling = proof.siblings[used++];
+        }
+        hash = bitAt(key, DEPTH - 1 - h) ? parentHash(h, sibling, hash) : parentHash(h, hash, sibling);
+    }
+    // Un frère en trop rend la preuve invalide
+    if (used != proof.siblings.size()) return false;
+    root = hash;
+    return true;
+}
+
+bool SparseMerkleTree::verifyProof(const Hash256& key, const Hash256& value, const SparseMerkleProof& proof, const Hash256& root) {
+    Hash256 computed;
+    return rootFromProof(key, value, proof, computed) && computed == root;
+}
@@ -0,0 +1,89 @@
+#ifndef SPARSE_MERKLE_TREE_H
+#define SPARSE_MERKLE_TREE_H
+
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../crypto/hash256.h"
+
+// Preuve d'une clé de l'arbre creux : ses 256 frères, dont seuls ceux qui ne
+// sont pas des sous-arbres vides sont transmis (les autres se recalculent)
+struct SparseMerkleProof {
+    std::bitset<256> present;       // Bit h : le frère de hauteur h est transmis
+    std::vector<Hash256> siblings;  // Frères non vides, de la feuille vers la racine
+};
+
+// Arbre de Merkle creux de profondeur 256 : une feuille par clé de 256 bits
+//
+// La feuille d'une clé est au bout du chemin formé par ses bits (le bit de
+// poids fort du premier octet choisit le côté sous la racine) et contient la
+// valeur associée ; une feuille absente vaut le hash nul. Un sous-arbre vide
+// de hauteur h a donc toujours le même hash, calculé une fois pour toutes :
+// seuls les nœuds non vides sont stockés et une preuve d'absence d'une clé
+// est une preuve ordinaire de la valeur nulle.
+class SparseMerkleTree {
+public:
+    static const size_t DEPTH = 256;
+
+private:
+    // Les préfixes sont des hash : leurs premiers octets suffisent à les disperser
+    struct PrefixHasher {
+        size_t operator()(const Hash256& prefix) const {
+            uint64_t value;
+            std::memcpy(&value, prefix.bytes, sizeof(value));
+            return static_cast<size_t>(value);
+        }
+    };
+    typedef std::unordered_map<Hash256, Hash256, PrefixHasher> Level;
+
+    // levels[h] : nœuds non vides de hauteur h (0 = feuilles), indexés par le
+    // préfixe de leur chemin (la clé dont les h derniers bits sont mis à zéro)
+    std::vector<Level> levels;
+
+    // Nœud de hauteur h, en regardant d'abord dans les nœuds recalculés
+    Hash256 node(size_t height, const Hash256& prefix, const std::vector<Level>& changed) const;
+
+    // Recalculer les chemins des clés modifiées sans toucher à l'arbre :
+    // changed[h] reçoit les nouveaux nœuds de hauteur h (ancêtres communs calculés une fois)
+    void rehash(const std::vector<std::pair<Hash256, Hash256>>& changes, std::vector<Level>& changed) const;
+
+public:
+    SparseMerkleTree();
+
+    // Hash d'un sous-arbre vide de hauteur height (0 à DEPTH)
+    static const Hash256& emptyHash(size_t height);
+
+    // Obtenir le hash racine
+    Hash256 getRootHash() const;
+
+    // Valeur associée à une clé (false si la clé est absente)
+    bool get(const Hash256& key, Hash256& value) const;
+
+    // Nombre de clés présentes
+    size_t size() const { return levels[0].size(); }
+
+    // Associer une valeur à une clé (la valeur nulle retire la clé)
+    void update(const Hash256& key, const Hash256& value);
+
+    // Appliquer plusieurs changements (clé, valeur) dans l'ordre ; chaque nœud
+    // touché n'est recalculé qu'une fois, quel que soit le nombre de clés sous lui
+    void update(const std::vector<std::pair<Hash256, Hash256>>& changes);
+
+    // Racine qu'aurait l'arbre après ces changements, sans les appliquer
+    Hash256 rootAfter(const std::vector<std::pair<Hash256, Hash256>>& changes) const;
+
+    // Preuve de la valeur d'une clé (d'absence si la clé n'est pas dans l'arbre)
+    SparseMerkleProof getProof(const Hash256& key) const;
+
+    // Racine obtenue en remontant la preuve depuis la valeur de la clé
+    // (false si la preuve est mal formée)
+    static bool rootFromProof(const Hash256& key, const Hash256& value, const SparseMerkleProof& proof, Hash256& root);
+
+    // Vérifier sans l'arbre que la clé a cette valeur (nulle : que la clé est absente)
+    static bool verifyProof(const Hash256& key, const Hash256& value, const SparseMerkleProof& proof, const Hash256& root);
+};
+
+#endif // SPARSE_MERKLE_TREE_H
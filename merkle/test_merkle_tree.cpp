@@ -2,6 +2,8 @@
 #include <vector>
 #include <string>
 #include "merkle_tree.h"
+#include "sparse_merkle_tree.h"
+#include "../crypto/sha256_mb.h"
 
 // Fonction d'aide pour afficher les résultats des tests
 void displayTestResult(const std::string& testName, bool result) {
@@ -17,8 +19,8 @@ bool testEvenNumberOfLeaves() {
     tree.printTree();
     
     // Vérifier que le hash racine n'est pas vide
-    std::string rootHash = tree.getRootHash();
-    return !rootHash.empty();
+    Hash256 rootHash = tree.getRootHash();
+    return !rootHash.isZero();
 }
 
 // Fonction pour tester la construction d'un arbre avec un nombre impair de feuilles
@@ -34,9 +36,9 @@ bool testOddNumberOfLeaves() {
     std::cout << "Tree printed" << std::endl;
     
     // Vérifier que le hash racine n'est pas vide
-    std::string rootHash = tree.getRootHash();
+    Hash256 rootHash = tree.getRootHash();
     std::cout << "Root hash obtained: " << rootHash << std::endl;
-    return !rootHash.empty();
+    return !rootHash.isZero();
 }
 
 // Fonction pour tester la vérification de la présence d'une donnée dans l'arbre
@@ -63,13 +65,13 @@ bool testHashConsistency() {
     MerkleTree tree2(data2);
     
     // Les hash racines doivent être identiques
-    std::string rootHash1 = tree1.getRootHash();
-    std::string rootHash2 = tree2.getRootHash();
+    Hash256 rootHash1 = tree1.getRootHash();
+    Hash256 rootHash2 = tree2.getRootHash();
     
     // Créer un arbre avec des données différentes
     std::vector<std::string> data3 = {"block1", "block2", "block3", "block5"};
     MerkleTree tree3(data3);
-    std::string rootHash3 = tree3.getRootHash();
+    Hash256 rootHash3 = tree3.getRootHash();
     
     return (rootHash1 == rootHash2) && (rootHash1 != rootHash3);
 }
@@ -82,9 +84,324 @@ bool testEmptyTree() {
     std::cout << "Empty tree:" << std::endl;
     tree.printTree();
     
-    // Le hash racine doit être vide
-    std::string rootHash = tree.getRootHash();
-    return rootHash.empty();
+    // Le hash racine doit être nul
+    Hash256 rootHash = tree.getRootHash();
+    return rootHash.isZero();
+}
+
+// Test du remplacement de la première feuille par sa branche (tailles paires et impaires)
+bool testLeftmostBranch() {
+    for (size_t count = 1; count <= 17; count++) {
+        std::vector<std::string> data;
+        for (size_t i = 0; i < count; i++) {
+            data.push_back("tx" + std::to_string(i));
+        }
+        std::vector<Hash256> branch = MerkleTree(data).getLeftmostBranch();
+        
+        // La racine recalculée doit être celle d'un arbre reconstruit entièrement
+        data[0] = "coinbase";
+        Hash256 expected = MerkleTree(data).getRootHash();
+        if (MerkleTree::rootFromLeftmostBranch(sha256(data[0]), branch) != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Test des chemins d'audit : chaque feuille se vérifie avec la racine seule
+bool testInclusionProofs() {
+    for (size_t count = 1; count <= 33; count++) {
+        std::vector<std::string> data;
+        for (size_t i = 0; i < count; i++) {
+            data.push_back("tx" + std::to_string(i));
+        }
+        MerkleTree tree(data);
+        Hash256 root = tree.getRootHash();
+
+        for (size_t i = 0; i < count; i++) {
+            MerkleProof proof;
+            if (!tree.getProof(i, proof) || !MerkleTree::verifyProof(data[i], proof, root)) {
+                return false;
+            }
+            // Une autre donnée ne doit pas passer avec ce chemin
+            if (MerkleTree::verifyProof("forged", proof, root)) {
+                return false;
+            }
+            // Ni la même donnée annoncée à une autre position (dès qu'elle a un frère distinct)
+            proof.index ^= 1;
+            if (count > 1 && (i ^ 1) < count && MerkleTree::verifyProof(data[i], proof, root)) {
+                return false;
+            }
+        }
+
+        MerkleProof outside;
+        if (tree.getProof(count, outside)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Test des preuves groupées : sous-ensembles variés, taille réduite, falsifications rejetées
+bool testMultiProofs() {
+    for (size_t count = 1; count <= 40; count++) {
+        std::vector<std::string> data;
+        for (size_t i = 0; i < count; i++) {
+            data.push_back("tx" + std::to_string(i));
+        }
+        MerkleTree tree(data);
+        Hash256 root = tree.getRootHash();
+
+        for (size_t step = 1; step <= 7; step += 3) {
+            std::vector<size_t> indices;
+            std::vector<std::string> proven;
+            for (size_t i = count / 3; i < count; i += step) {
+                indices.push_back(i);
+                proven.push_back(data[i]);
+            }
+
+            MerkleMultiProof proof;
+            if (!tree.getMultiProof(indices, proof) || !MerkleTree::verifyMultiProof(proven, proof, root)) {
+                return false;
+            }
+
+            // Jamais plus de hash que l'ensemble des preuves individuelles
+            size_t separate = 0;
+            for (size_t index : indices) {
+                MerkleProof single;
+                tree.getProof(index, single);
+                separate += single.siblings.size();
+            }
+            if (proof.hashes.size() > separate) {
+                return false;
+            }
+
+            std::vector<std::string> forged(proven);
+            forged.back() = "forged";
+            if (MerkleTree::verifyMultiProof(forged, proof, root)) {
+                return false;
+            }
+            if (!proof.hashes.empty()) {
+                MerkleMultiProof truncated(proof);
+                truncated.hashes.pop_back();
+                if (MerkleTree::verifyMultiProof(proven, truncated, root)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    std::vector<std::string> data = {"a", "b", "c"};
+    MerkleMultiProof proof;
+    return !MerkleTree(data).getMultiProof(std::vector<size_t>{0, 3}, proof);
+}
+
+// Test de la construction parallèle : mêmes nœuds quel que soit le nombre de threads
+bool testParallelBuild() {
+    for (size_t count : {MerkleTree::PARALLEL_THRESHOLD * 5 + 3, MerkleTree::PARALLEL_THRESHOLD * 8}) {
+        std::vector<std::string> data;
+        for (size_t i = 0; i < count; i++) {
+            data.push_back("tx" + std::to_string(i));
+        }
+        MerkleTree serial(data, 1);
+        for (unsigned threads : {2u, 3u, 8u}) {
+            MerkleTree parallel(data, threads);
+            MerkleProof a, b;
+            if (parallel.getRootHash() != serial.getRootHash() ||
+                parallel.getAllLeafHashes() != serial.getAllLeafHashes() ||
+                !parallel.getProof(count - 1, a) || !serial.getProof(count - 1, b) || a.siblings != b.siblings) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Test du hachage des niveaux par paquets : chaque backend SIMD donne
+// les mêmes nœuds que hashPair appliqué paire par paire
+bool testSimdLevels() {
+    std::vector<Hash256> leaves;
+    for (size_t i = 0; i < 37; i++) {
+        leaves.push_back(sha256("tx" + std::to_string(i)));
+    }
+    std::vector<Hash256> level = leaves;
+    while (level.size() > 1) {
+        std::vector<Hash256> parents;
+        for (size_t i = 0; i < level.size(); i += 2) {
+            parents.push_back(MerkleTree::hashPair(level[i], i + 1 < level.size() ? level[i + 1] : level[i]));
+        }
+        level = parents;
+    }
+
+    sha256mb::Backend original = sha256mb::activeBackend();
+    bool passed = true;
+    for (sha256mb::Backend backend : {sha256mb::SCALAR, sha256mb::AVX2, sha256mb::AVX512}) {
+        if (sha256mb::setBackend(backend)) {
+            passed = passed && MerkleTree(leaves).getRootHash() == level[0];
+        }
+    }
+    sha256mb::setBackend(original);
+    return passed;
+}
+
+// Test de l'accumulateur : même racine qu'un arbre complet après chaque ajout
+bool testAccumulator() {
+    MerkleAccumulator accumulator;
+    if (!accumulator.getRootHash().isZero()) {
+        return false;
+    }
+
+    std::vector<std::string> data;
+    for (size_t count = 1; count <= 130; count++) {
+        data.push_back("tx" + std::to_string(count));
+        accumulator.add(data.back());
+        if (accumulator.getRootHash() != MerkleTree(data).getRootHash()) {
+            return false;
+        }
+    }
+
+    accumulator.clear();
+    return accumulator.getLeafCount() == 0 && accumulator.getRootHash().isZero();
+}
+
+// Test des mises à jour : même arbre qu'une reconstruction complète
+bool testUpdates() {
+    for (size_t count = 1; count <= 37; count++) {
+        std::vector<std::string> data;
+        for (size_t i = 0; i < count; i++) {
+            data.push_back("tx" + std::to_string(i));
+        }
+        MerkleTree tree(data);
+
+        // Une feuille à la fois, y compris la dernière d'un niveau impair
+        for (size_t i = 0; i < count; i += 3) {
+            data[i] = "replaced" + std::to_string(i);
+            if (!tree.update(i, data[i]) || tree.getRootHash() != MerkleTree(data).getRootHash()) {
+                return false;
+            }
+        }
+
+        // Plusieurs feuilles voisines (ancêtres partagés), avec une position répétée
+        std::vector<std::pair<size_t, std::string>> changes;
+        for (size_t i = count / 2; i < count; i++) {
+            changes.push_back(std::make_pair(i, "bulk" + std::to_string(i)));
+        }
+        changes.push_back(std::make_pair(count - 1, std::string("last")));
+        for (const auto& change : changes) {
+            data[change.first] = change.second;
+        }
+        if (!tree.update(changes) || tree.getRootHash() != MerkleTree(data).getRootHash()) {
+            return false;
+        }
+
+        // Une position hors de l'arbre est refusée sans rien modifier
+        Hash256 before = tree.getRootHash();
+        changes.push_back(std::make_pair(count, std::string("outside")));
+        if (tree.update(changes) || tree.update(count, "outside") || tree.getRootHash() != before) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Test de l'index des feuilles : mêmes réponses que le parcours, y compris après des mises à jour
+bool testLeafIndex() {
+    std::vector<std::string> data;
+    for (size_t i = 0; i < 3000; i++) {
+        // Quelques doublons
+        data.push_back("tx" + std::to_string(i % 2900));
+    }
+    MerkleTree tree(data);
+    if (tree.hasLeafIndex() || !tree.buildLeafIndex() || !tree.hasLeafIndex()) {
+        return false;
+    }
+
+    // Remplacer des feuilles, dont des doublons, pour exercer le retrait de l'index
+    std::vector<std::pair<size_t, std::string>> changes;
+    for (size_t i = 0; i < data.size(); i += 7) {
+        data[i] = "new" + std::to_string(i);
+        changes.push_back(std::make_pair(i, data[i]));
+    }
+    tree.update(changes);
+    data[5] = "single";
+    tree.update(5, data[5]);
+
+    for (size_t i = 0; i < data.size(); i++) {
+        size_t index = 0;
+        MerkleProof proof;
+        if (!tree.findLeaf(data[i], index) || data[index] != data[i]) {
+            return false;
+        }
+        if (!tree.getProofFor(data[i], proof) || !MerkleTree::verifyProof(data[i], proof, tree.getRootHash())) {
+            return false;
+        }
+    }
+
+    size_t index = 0;
+    return !tree.verify("tx105") && !tree.findLeaf("absent", index) && tree.verify("new0");
+}
+
+// Test de la construction à partir des hash des feuilles
+bool testLeafHashConstructor() {
+    std::vector<std::string> data;
+    std::vector<Hash256> leafHashes;
+    for (size_t i = 0; i < 37; i++) {
+        data.push_back("tx" + std::to_string(i));
+        leafHashes.push_back(sha256(data.back()));
+    }
+    MerkleTree fromData(data);
+    MerkleTree fromHashes(leafHashes);
+    return fromHashes.getRootHash() == fromData.getRootHash() &&
+           fromHashes.getLeafCount() == data.size() && fromHashes.verify("tx36") &&
+           MerkleTree(std::vector<Hash256>()).getRootHash() == Hash256();
+}
+
+// Test de l'arbre creux : mises à jour groupées ou une à une, preuves de présence et d'absence
+bool testSparseMerkleTree() {
+    std::vector<std::pair<Hash256, Hash256>> changes;
+    for (size_t i = 0; i < 200; i++) {
+        changes.push_back(std::make_pair(sha256("account" + std::to_string(i)), sha256("balance" + std::to_string(i))));
+    }
+
+    SparseMerkleTree one, batch;
+    Hash256 empty = one.getRootHash();
+    if (empty != SparseMerkleTree::emptyHash(SparseMerkleTree::DEPTH) || batch.rootAfter(changes) == empty) {
+        return false;
+    }
+    Hash256 expected = batch.rootAfter(changes);
+    for (const auto& change : changes) {
+        one.update(change.first, change.second);
+    }
+    batch.update(changes);
+    if (one.getRootHash() != expected || batch.getRootHash() != expected || batch.size() != changes.size()) {
+        return false;
+    }
+
+    // Présence, absence et preuves falsifiées
+    for (size_t i = 0; i < changes.size(); i += 17) {
+        SparseMerkleProof proof = batch.getProof(changes[i].first);
+        if (!SparseMerkleTree::verifyProof(changes[i].first, changes[i].second, proof, expected) ||
+            SparseMerkleTree::verifyProof(changes[i].first, Hash256::zero(), proof, expected)) {
+            return false;
+        }
+    }
+    Hash256 absent = sha256("absent");
+    SparseMerkleProof proof = batch.getProof(absent);
+    if (!SparseMerkleTree::verifyProof(absent, Hash256::zero(), proof, expected) || proof.siblings.size() > 32) {
+        return false;
+    }
+    proof.siblings.push_back(Hash256::zero());
+    if (SparseMerkleTree::verifyProof(absent, Hash256::zero(), proof, expected)) {
+        return false;
+    }
+
+    // Retirer toutes les clés redonne l'arbre vide
+    for (auto& change : changes) {
+        change.second = Hash256::zero();
+    }
+    batch.update(changes);
+    Hash256 value;
+    return batch.getRootHash() == empty && batch.size() == 0 && !batch.get(changes[0].first, value);
 }
 
 // Fonction principale exécutant les tests
@@ -119,7 +436,7 @@ int main() {
             
             std::string dataToVerify = "block1";
             std::cout << "Calculating hash..." << std::endl;
-            std::string dataHash = sha256(dataToVerify);
+            Hash256 dataHash = sha256(dataToVerify);
             
             std::cout << "Hash of '" << dataToVerify << "': " << dataHash << std::endl;
             std::cout << "Is '" << dataToVerify << "' in the tree: " << (tree.verify(dataToVerify) ? "Yes" : "No") << std::endl;
@@ -219,7 +536,7 @@ int main() {
             
             std::string dataToVerify = "block1";
             std::cout << "Calculating hash..." << std::endl;
-            std::string dataHash = sha256(dataToVerify);
+            Hash256 dataHash = sha256(dataToVerify);
             
             std::cout << "Hash of '" << dataToVerify << "': " << dataHash << std::endl;
             std::cout << "Is '" << dataToVerify << "' in the tree: " << (tree.verify(dataToVerify) ? "Yes" : "No") << std::endl;
@@ -239,6 +556,36 @@ int main() {
         displayTestResult("Empty tree", testEmptyTree());
         std::cout << std::endl;
         
+        displayTestResult("Leftmost branch", testLeftmostBranch());
+        std::cout << std::endl;
+        
+        displayTestResult("Inclusion proofs", testInclusionProofs());
+        std::cout << std::endl;
+        
+        displayTestResult("Multiproofs", testMultiProofs());
+        std::cout << std::endl;
+        
+        displayTestResult("Parallel build", testParallelBuild());
+        std::cout << std::endl;
+        
+        displayTestResult("SIMD levels", testSimdLevels());
+        std::cout << std::endl;
+        
+        displayTestResult("Accumulator", testAccumulator());
+        std::cout << std::endl;
+        
+        displayTestResult("Updates", testUpdates());
+        std::cout << std::endl;
+        
+        displayTestResult("Leaf index", testLeafIndex());
+        std::cout << std::endl;
+        
+        displayTestResult("Leaf hash constructor", testLeafHashConstructor());
+        std::cout << std::endl;
+        
+        displayTestResult("Sparse Merkle tree", testSparseMerkleTree());
+        std::cout << std::endl;
+        
         // Test supplémentaire avec un exemple concret de blockchain
         std::cout << "===== BLOCKCHAIN EXAMPLE =====" << std::endl << std::endl;
         
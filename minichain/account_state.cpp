@@ -0,0 +1,77 @@
+#include "account_state.h"
+#include <cstring>
+#include "../common/serialize.h"
+#include "../crypto/sha256.h"
+
+std::map<std::string, double> AccountState::balancesAfter(const std::vector<Transaction>& transactions) const {
+    std::map<std::string, double> updated;
+    for (const auto& tx : transactions) {
+        const std::string parties[2] = { tx.getSender(), tx.getReceiver() };
+        const double deltas[2] = { -tx.getAmount(), tx.getAmount() };
+        for (int i = 0; i < 2; i++) {
+            if (parties[i].empty()) continue;
+            std::map<std::string, double>::iterator it = updated.find(parties[i]);
+            if (it == updated.end()) {
+                it = updated.insert(std::make_pair(parties[i], getBalance(parties[i]))).first;
+            }
+            it->second += deltas[i];
+        }
+    }
+    return updated;
+}
+
+std::vector<std::pair<Hash256, Hash256>> AccountState::treeChanges(const std::map<std::string, double>& updated) {
+    std::vector<std::pair<Hash256, Hash256>> changes;
+    changes.reserve(updated.size());
+    for (const auto& account : updated) {
+        changes.push_back(std::make_pair(accountKey(account.first), accountValue(account.second)));
+    }
+    return changes;
+}
+
+void AccountState::apply(const std::vector<Transaction>& transactions) {
+    std::map<std::string, double> updated = balancesAfter(transactions);
+    for (const auto& account : updated) {
+        if (account.second == 0) {
+            balances.erase(account.first);
+        } else {
+            balances[account.first] = account.second;
+        }
+    }
+    tree.update(treeChanges(updated));
+}
+
+Hash256 AccountState::rootAfter(const std::vector<Transaction>& transactions) const {
+    return tree.rootAfter(treeChanges(balancesAfter(transactions)));
+}
+
+double AccountState::getBalance(const std::string& address) const {
+    std::map<std::string, double>::const_iterator it = balances.find(address);
+    return it != balances.end() ? it->second : 0;
+}
+
+SparseMerkleProof AccountState::getProof(const std::string& address) const {
+    return tree.getProof(accountKey(address));
+}
+
+Hash256 AccountState::accountKey(const std::string& address) {
+    return sha256(address);
+}
+
+Hash256 AccountState::accountValue(double balance) {
+    // Zero balances (including -0) are absent from the tree
+    if (balance == 0) {
+        return Hash256::zero();
+    }
+    // The exact bits of the balance, little-endian, so every node hashes the same bytes
+    uint64_t bits;
+    std::memcpy(&bits, &balance, sizeof(bits));
+    uint8_t buffer[8];
+    writeLE64(buffer, bits);
+    return sha256(buffer, sizeof(buffer));
+}
+
+bool AccountState::verifyBalance(const std::string& address, double balance,
+                                 const SparseMerkleProof& proof, const Hash256& root) {
+    return SparseMerkleTree::verifyProof(accountKey(address), accountValue(balance), proof, root);
+}
@@ -0,0 +1,83 @@
+#ifndef ACCOUNT_STATE_H
+#define ACCOUNT_STATE_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../merkle/sparse_merkle_tree.h"
+#include "transaction.h"
+
+/**
+ * Account balances committed by a sparse Merkle tree
+ *
+ * Each address is a leaf keyed by its SHA-256; the leaf holds the hash of the
+ * balance, and accounts with a zero balance are absent. Every block header
+ * commits to the root, so a balance can be proven against a header and its
+ * state root (a zero balance by a proof of absence) instead of replaying the chain.
+ */
+class AccountState {
+private:
+    std::map<std::string, double> balances; // Non-zero balances by address
+    SparseMerkleTree tree;                  // Commitment of balances
+
+    /**
+     * Balances of the accounts touched by the transactions once they are applied
+     * (the sender pays the amount to the receiver; coinbases have no sender)
+     */
+    std::map<std::string, double> balancesAfter(const std::vector<Transaction>& transactions) const;
+
+    /**
+     * Tree changes that write the given balances
+     */
+    static std::vector<std::pair<Hash256, Hash256>> treeChanges(const std::map<std::string, double>& updated);
+
+public:
+    /**
+     * Apply the transactions of a block (one batched tree update)
+     */
+    void apply(const std::vector<Transaction>& transactions);
+
+    /**
+     * Get the state root (committed in the block header)
+     */
+    Hash256 getRoot() const { return tree.getRootHash(); }
+
+    /**
+     * Get the state root the transactions would give, without applying them
+     */
+    Hash256 rootAfter(const std::vector<Transaction>& transactions) const;
+
+    /**
+     * Get the balance of an address (0 for unknown addresses)
+     */
+    double getBalance(const std::string& address) const;
+
+    /**
+     * Get the proof of an address's balance against getRoot()
+     */
+    SparseMerkleProof getProof(const std::string& address) const;
+
+    /**
+     * Get the number of accounts with a non-zero balance
+     */
+    size_t getAccountCount() const { return balances.size(); }
+
+    /**
+     * Tree key of an address
+     */
+    static Hash256 accountKey(const std::string& address);
+
+    /**
+     * Tree value of a balance (zero hash for a zero balance)
+     */
+    static Hash256 accountValue(double balance);
+
+    /**
+     * Check, without the state, that an address has this balance under the given root
+     */
+    static bool verifyBalance(const std::string& address, double balance,
+                              const SparseMerkleProof& proof, const Hash256& root);
+};
+
+#endif // ACCOUNT_STATE_H
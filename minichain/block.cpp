@@ -2,75 +2,197 @@
 #include <sstream>
 #include <iomanip>
 #include <iostream>
+#include <algorithm>
 #include <chrono>
-#include <openssl/sha.h>
+#include <limits>
+#include <memory>
+#include "../crypto/sha256_mb.h"
+#include "../common/arena.h"
 
-// Helper function to calculate SHA-256 hash
-inline std::string sha256(const std::string& str) {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, str.c_str(), str.size());
-    SHA256_Final(hash, &sha256);
-    
-    std::stringstream ss;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i];
-    }
-    return ss.str();
-}
-
-Block::Block(int index, const std::vector<Transaction>& transactions, const std::string& previousHash)
+Block::Block(int index, const std::vector<Transaction>& transactions, const Hash256& previousHash,
+             const Hash256& stateRoot)
     : index(index), timestamp(std::time(nullptr)), previousHash(previousHash), 
-      transactions(transactions), nonce(0), validator("") {
+      stateRoot(stateRoot), transactions(transactions), bits(0), nonce(0), validator(""), 
+      lastMiningSeconds(0) {
     // Calculate Merkle root for the transactions
-    merkleRoot = calculateMerkleRoot();
+    calculateMerkleRoot();
     // Calculate the initial hash
     hash = calculateHash();
 }
 
-std::string Block::calculateMerkleRoot() const {
-    // If there are no transactions, return a placeholder hash
-    if (transactions.empty()) {
-        return sha256("empty_merkle_root");
+std::vector<Hash256> Block::leafHashes(const std::vector<Transaction>& transactions) {
+    // Serialize every transaction into one arena instead of one string each,
+    // sized from upper bounds up front so it takes a single heap block and
+    // each transaction is formatted only once
+    size_t total = 0;
+    for (const auto& tx : transactions) {
+        total += tx.maxSerializedSize() + 1;
     }
     
-    // Extract transaction strings for Merkle tree
-    std::vector<std::string> transactionStrings;
+    MonotonicArena arena(total);
+    std::vector<Hash256> hashes;
+    hashes.reserve(transactions.size());
     for (const auto& tx : transactions) {
-        transactionStrings.push_back(tx.toString());
+        size_t capacity = tx.maxSerializedSize() + 1;
+        char* text = static_cast<char*>(arena.allocate(capacity, 1));
+        size_t length = tx.serialize(text, capacity);
+        hashes.push_back(sha256(reinterpret_cast<const unsigned char*>(text), length));
+    }
+    return hashes;
+}
+
+void Block::calculateMerkleRoot() {
+    coinbaseBranch.clear();
+    
+    // If there are no transactions, use a placeholder hash
+    if (transactions.empty()) {
+        merkleRoot = sha256("empty_merkle_root");
+        return;
     }
     
-    // Create Merkle tree and get root hash
-    MerkleTree merkleTree(transactionStrings);
-    return merkleTree.getRootHash();
+    // Create Merkle tree from the leaf hashes and get root hash
+    MerkleTree merkleTree(leafHashes(transactions));
+    merkleRoot = merkleTree.getRootHash();
+    // The siblings of the first leaf do not depend on it: keep them for rollExtraNonce
+    coinbaseBranch = merkleTree.getLeftmostBranch();
 }
 
-std::string Block::calculateHash() const {
-    std::stringstream ss;
-    ss << index << timestamp << previousHash << merkleRoot << nonce << validator;
-    return sha256(ss.str());
+Hash256 Block::computeMerkleRoot() const {
+    if (transactions.empty()) {
+        return sha256("empty_merkle_root");
+    }
+    return MerkleTree(leafHashes(transactions)).getRootHash();
 }
 
-long Block::mineBlock(int difficulty) {
-    // Create a target string with leading zeros
-    std::string target(difficulty, '0');
+bool Block::rollExtraNonce() {
+    if (transactions.empty() || !transactions[0].isCoinbase()) {
+        return false;
+    }
     
+    const Transaction& coinbase = transactions[0];
+    transactions[0] = Transaction::makeCoinbase(coinbase.getReceiver(), coinbase.getExtraNonce() + 1);
+    merkleRoot = MerkleTree::rootFromLeftmostBranch(sha256(transactions[0].toString()), coinbaseBranch);
+    nonce = 0;
+    return true;
+}
+
+uint64_t Block::getExtraNonce() const {
+    return !transactions.empty() && transactions[0].isCoinbase() ? transactions[0].getExtraNonce() : 0;
+}
+
+template <typename Search>
+MiningResult Block::searchWithExtraNonce(Search search, const CancelFlag& cancelled) {
+    MiningResult total;
+    while (true) {
+        // The Merkle root is in the header prefix, so each round needs a new searcher
+        MiningResult result = search(makeNonceSearch(Target::fromCompact(bits)));
+        
+        total.found = result.found;
+        total.nonce = result.nonce;
+        total.hashesPerThread.resize(std::max(total.hashesPerThread.size(), result.hashesPerThread.size()), 0);
+        for (size_t i = 0; i < result.hashesPerThread.size(); i++) {
+            total.hashesPerThread[i] += result.hashesPerThread[i];
+        }
+        
+        if (result.found || (cancelled && cancelled->load()) || !rollExtraNonce()) {
+            return total;
+        }
+    }
+}
+
+void Block::rebase(int index, const Hash256& previousHash, const Hash256& stateRoot) {
+    this->index = index;
+    this->previousHash = previousHash;
+    this->stateRoot = stateRoot;
+    timestamp = std::time(nullptr);
+    nonce = 0;
+    hash = calculateHash();
+}
+
+BlockHeader Block::getHeader() const {
+    BlockHeader header;
+    header.index = static_cast<uint32_t>(index);
+    header.timestamp = static_cast<uint32_t>(timestamp);
+    header.previousHash = previousHash;
+    header.merkleRoot = merkleRoot;
+    // The validator address is committed through its hash to keep the header fixed-size
+    Hash256 validatorHash = validator.empty() ? Hash256::zero() : sha256(validator);
+    header.commitmentHash = BlockHeader::commit(stateRoot, validatorHash);
+    header.bits = bits;
+    header.nonce = nonce;
+    return header;
+}
+
+Hash256 Block::calculateHash() const {
+    return getHeader().hash();
+}
+
+NonceSearch Block::makeNonceSearch(const Target& target) const {
+    // The header bytes before the nonce never change while mining: their whole
+    // SHA-256 block is absorbed once, then nonces are hashed several lanes at a time
+    uint8_t buffer[BlockHeader::SIZE];
+    getHeader().serialize(buffer);
+    std::shared_ptr<const sha256mb::NonceHasher> hasher = std::make_shared<sha256mb::NonceHasher>(
+        std::string(reinterpret_cast<const char*>(buffer), BlockHeader::NONCE_OFFSET));
+    
+    return [hasher, target](uint64_t begin, uint64_t end, uint64_t& found, uint64_t& tried) {
+        return hasher->search(begin, end, [&target](const Hash256& digest) {
+            return target.isMetBy(digest);
+        }, found, tried);
+    };
+}
+
+long Block::mineBlock(uint32_t targetBits, unsigned threads) {
     // Record start time
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    // Increment nonce until we find a hash with the required number of leading zeros
-    while (hash.substr(0, difficulty) != target) {
-        nonce++;
+    // The target is part of the header, so it is set before the prefix is hashed
+    bits = targetBits;
+    
+    // Split the nonce space between the workers; the first valid nonce wins
+    MiningResult result = searchWithExtraNonce([this, threads](const NonceSearch& search) {
+        return mineParallel(threads, nonce, std::numeric_limits<uint64_t>::max(), search);
+    }, CancelFlag());
+    return finishMining(result, startTime);
+}
+
+long Block::mineBlock(uint32_t targetBits, MiningPool& pool, CancelFlag cancelled) {
+    // Record start time
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    bits = targetBits;
+    
+    // Hand the template to the already running workers
+    MiningResult result = searchWithExtraNonce([this, &pool, &cancelled](const NonceSearch& search) {
+        return pool.mine(search, nonce, std::numeric_limits<uint64_t>::max(), cancelled);
+    }, cancelled);
+    return finishMining(result, startTime);
+}
+
+bool Block::meetsTarget() const {
+    return Target::isValidCompact(bits) && Target::fromCompact(bits).isMetBy(hash);
+}
+
+long Block::finishMining(const MiningResult& result, 
+                         std::chrono::high_resolution_clock::time_point startTime) {
+    if (result.found) {
+        nonce = result.nonce;
         hash = calculateHash();
     }
+    lastMiningResult = result;
     
     // Record end time and calculate duration
     auto endTime = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    lastMiningSeconds = std::chrono::duration<double>(endTime - startTime).count();
     
-    std::cout << "Block mined! Hash: " << hash << std::endl;
-    std::cout << "Mining time: " << duration << " ms" << std::endl;
+    if (result.found) {
+        std::cout << "Block mined! Hash: " << hash << std::endl;
+    } else {
+        std::cout << "Mining of block #" << index << " abandoned" << std::endl;
+    }
+    std::cout << "Mining time: " << duration << " ms (" << result.totalHashes() 
+              << " hashes, " << result.hashesPerThread.size() << " threads)" << std::endl;
     
     return duration;
 }
@@ -101,6 +223,7 @@ std::string Block::toString() const {
     ss << "  Timestamp: " << timestamp << std::endl;
     ss << "  Previous Hash: " << previousHash << std::endl;
     ss << "  Merkle Root: " << merkleRoot << std::endl;
+    ss << "  State Root: " << stateRoot << std::endl;
     ss << "  Transactions: " << transactions.size() << std::endl;
     for (size_t i = 0; i < transactions.size(); i++) {
         if (i < 3) { // Show only first 3 transactions to avoid clutter
@@ -115,6 +238,7 @@ std::string Block::toString() const {
     if (!validator.empty()) {
         ss << "  Validator: " << validator << std::endl;
     } else {
+        ss << "  Bits: 0x" << std::hex << bits << std::dec << std::endl;
         ss << "  Nonce: " << nonce << std::endl;
     }
     ss << "  Hash: " << hash << std::endl;
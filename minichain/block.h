@@ -4,7 +4,12 @@
 #include <string>
 #include <vector>
 #include <ctime>
+#include <chrono>
 #include "../merkle/merkle_tree.h"
+#include "block_header.h"
+#include "../crypto/target.h"
+#include "../common/parallel_miner.h"
+#include "mining_pool.h"
 #include "transaction.h"
 
 /**
@@ -15,17 +20,50 @@ class Block {
 private:
     int index;                   // Block index in the blockchain
     time_t timestamp;            // Time the block was created
-    std::string previousHash;    // Hash of the previous block
-    std::string merkleRoot;      // Merkle root of transactions
+    Hash256 previousHash;        // Hash of the previous block
+    Hash256 merkleRoot;          // Merkle root of transactions
+    Hash256 stateRoot;           // Root of the account state after this block
     std::vector<Transaction> transactions; // Transactions in this block
-    int nonce;                   // Nonce for PoW
+    std::vector<Hash256> coinbaseBranch;   // Siblings of the first Merkle leaf, bottom-up
+    uint32_t bits;               // Compact PoW target the block was mined for (0 if not mined)
+    uint64_t nonce;              // Nonce for PoW
     std::string validator;       // Validator address for PoS
-    std::string hash;            // Hash of this block
+    Hash256 hash;                // Hash of this block
+    MiningResult lastMiningResult; // Outcome of the last mineBlock call
+    double lastMiningSeconds;      // Wall-clock duration of the last mineBlock call
 
     /**
-     * Calculate the Merkle root of the transactions
+     * Calculate the Merkle root of the transactions and cache the branch of the first leaf
      */
-    std::string calculateMerkleRoot() const;
+    void calculateMerkleRoot();
+    
+    /**
+     * Hash every transaction into a Merkle leaf
+     */
+    static std::vector<Hash256> leafHashes(const std::vector<Transaction>& transactions);
+    
+    /**
+     * Search the whole nonce space, rolling the extra nonce each time it is exhausted
+     * 
+     * @param search Runs one full nonce search for the current header
+     * @param cancelled Stops the rounds once set (may be null)
+     */
+    template <typename Search>
+    MiningResult searchWithExtraNonce(Search search, const CancelFlag& cancelled);
+    
+    /**
+     * Build the thread-safe chunk searcher used by the miners
+     * (shares the SHA-256 midstate of the header bytes before the nonce)
+     */
+    NonceSearch makeNonceSearch(const Target& target) const;
+    
+    /**
+     * Apply a mining result to the block and report it
+     * 
+     * @return Time elapsed since startTime in milliseconds
+     */
+    long finishMining(const MiningResult& result, 
+                      std::chrono::high_resolution_clock::time_point startTime);
     
 public:
     /**
@@ -34,21 +72,74 @@ public:
      * @param index Index in the blockchain
      * @param transactions List of transactions to include
      * @param previousHash Hash of the previous block
+     * @param stateRoot Root of the account state once the transactions are applied
      */
-    Block(int index, const std::vector<Transaction>& transactions, const std::string& previousHash);
+    Block(int index, const std::vector<Transaction>& transactions, const Hash256& previousHash,
+          const Hash256& stateRoot = Hash256::zero());
+    
+    /**
+     * Move a prepared block onto a new parent
+     * 
+     * Transactions and Merkle root are kept, so a template built ahead of time
+     * only needs this when the block before it is appended. The state root,
+     * which depends on the parent's state, is replaced; the timestamp is
+     * refreshed and the nonce restarts at 0.
+     * 
+     * @param index Index in the blockchain
+     * @param previousHash Hash of the new previous block
+     * @param stateRoot Root of the account state once the transactions are applied on the new parent
+     */
+    void rebase(int index, const Hash256& previousHash, const Hash256& stateRoot);
+    
+    /**
+     * Build the binary header (hash preimage, storage and network format)
+     */
+    BlockHeader getHeader() const;
     
     /**
      * Calculate the hash of the block
      */
-    std::string calculateHash() const;
+    Hash256 calculateHash() const;
     
     /**
      * Mine the block with Proof of Work
      * 
-     * @param difficulty Mining difficulty (number of leading zeros)
+     * @param targetBits Compact target the hash must not exceed (stored in the header)
+     * @param threads Number of worker threads sharing the nonce space
      * @return Time taken to mine the block in milliseconds
      */
-    long mineBlock(int difficulty);
+    long mineBlock(uint32_t targetBits, unsigned threads = 1);
+    
+    /**
+     * Mine the block with Proof of Work on a persistent worker pool
+     * 
+     * @param targetBits Compact target the hash must not exceed (stored in the header)
+     * @param pool Pool whose parked workers search the nonce space
+     * @param cancelled Optional flag that abandons the search once set (the block
+     *                  is then left unmined: getMiningResult().found is false)
+     * @return Time taken to mine the block in milliseconds
+     */
+    long mineBlock(uint32_t targetBits, MiningPool& pool, CancelFlag cancelled = CancelFlag());
+    
+    /**
+     * Give the miners a fresh nonce space by incrementing the coinbase extra nonce
+     * 
+     * Only the first Merkle leaf changes, so the root is recomputed from the cached
+     * branch (log n hashes) instead of rebuilding the tree. The nonce restarts at 0.
+     * 
+     * @return false if the block has no coinbase transaction
+     */
+    bool rollExtraNonce();
+    
+    /**
+     * Get the extra nonce of the coinbase transaction (0 without one)
+     */
+    uint64_t getExtraNonce() const;
+    
+    /**
+     * Check that the hash meets the target committed in the header (PoW)
+     */
+    bool meetsTarget() const;
     
     /**
      * Validate the block with Proof of Stake
@@ -61,18 +152,38 @@ public:
     /**
      * Get the block hash
      */
-    std::string getHash() const { return hash; }
+    Hash256 getHash() const { return hash; }
     
     /**
      * Get the hash of the previous block
      */
-    std::string getPreviousHash() const { return previousHash; }
+    Hash256 getPreviousHash() const { return previousHash; }
     
     /**
      * Get the block index
      */
     int getIndex() const { return index; }
     
+    /**
+     * Get the nonce (PoW)
+     */
+    uint64_t getNonce() const { return nonce; }
+    
+    /**
+     * Get the compact PoW target (0 for PoS blocks)
+     */
+    uint32_t getBits() const { return bits; }
+    
+    /**
+     * Get the winning nonce and per-thread hash counts of the last mining run
+     */
+    const MiningResult& getMiningResult() const { return lastMiningResult; }
+    
+    /**
+     * Get the duration of the last mining run in seconds
+     */
+    double getMiningSeconds() const { return lastMiningSeconds; }
+    
     /**
      * Get the block timestamp
      */
@@ -81,7 +192,17 @@ public:
     /**
      * Get the block's Merkle root
      */
-    std::string getMerkleRoot() const { return merkleRoot; }
+    Hash256 getMerkleRoot() const { return merkleRoot; }
+    
+    /**
+     * Recompute the Merkle root from the transactions (to check the committed one)
+     */
+    Hash256 computeMerkleRoot() const;
+    
+    /**
+     * Get the root of the account state after this block
+     */
+    Hash256 getStateRoot() const { return stateRoot; }
     
     /**
      * Get the block's transactions
@@ -0,0 +1,40 @@
+#include "block_header.h"
+#include "../common/serialize.h"
+#include "../crypto/sha256.h"
+
+constexpr size_t BlockHeader::SIZE;
+constexpr size_t BlockHeader::NONCE_OFFSET;
+
+void BlockHeader::serialize(uint8_t* out) const {
+    uint8_t* p = writeLE32(out, index);
+    p = writeLE32(p, timestamp);
+    p = writeHash(p, previousHash);
+    p = writeHash(p, merkleRoot);
+    p = writeHash(p, commitmentHash);
+    p = writeLE32(p, bits);
+    writeLE64(p, nonce);
+}
+
+BlockHeader BlockHeader::deserialize(const uint8_t* in) {
+    BlockHeader header;
+    header.index = readLE32(in);
+    header.timestamp = readLE32(in + 4);
+    header.previousHash = readHash(in + 8);
+    header.merkleRoot = readHash(in + 40);
+    header.commitmentHash = readHash(in + 72);
+    header.bits = readLE32(in + 104);
+    header.nonce = readLE64(in + NONCE_OFFSET);
+    return header;
+}
+
+Hash256 BlockHeader::hash() const {
+    uint8_t buffer[SIZE];
+    serialize(buffer);
+    return sha256(buffer, SIZE);
+}
+
+Hash256 BlockHeader::commit(const Hash256& stateRoot, const Hash256& validatorHash) {
+    uint8_t buffer[64];
+    writeHash(writeHash(buffer, stateRoot), validatorHash);
+    return sha256(buffer, sizeof(buffer));
+}
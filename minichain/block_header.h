@@ -0,0 +1,67 @@
+#ifndef BLOCK_HEADER_H
+#define BLOCK_HEADER_H
+
+#include <cstdint>
+#include <cstddef>
+#include "../crypto/hash256.h"
+
+/**
+ * Fixed-layout binary block header
+ *
+ * Integers are little-endian and hashes are raw 32-byte digests, so the
+ * encoding is the same on every platform and locale. It is the SHA-256
+ * preimage of the block and the form used to store or send a header.
+ *
+ *   offset  size  field
+ *        0     4  index
+ *        4     4  timestamp (seconds since the epoch)
+ *        8    32  previous block hash
+ *       40    32  Merkle root of the transactions
+ *       72    32  commitment hash (see commit: state root and validator hash)
+ *      104     4  bits (compact PoW target, zero for PoS)
+ *      108     8  nonce
+ *
+ * The nonce comes last: while mining, the first 64 bytes (a whole SHA-256
+ * block) never change and the nonce lands in the second and last block. The
+ * state root and the validator hash share one field to keep it that way.
+ */
+struct BlockHeader {
+    static constexpr size_t SIZE = 116;
+    static constexpr size_t NONCE_OFFSET = 108;
+
+    uint32_t index;
+    uint32_t timestamp;
+    Hash256 previousHash;
+    Hash256 merkleRoot;
+    Hash256 commitmentHash;
+    uint32_t bits;
+    uint64_t nonce;
+
+    /**
+     * Write the header into out (SIZE bytes)
+     */
+    void serialize(uint8_t* out) const;
+
+    /**
+     * Read a header written by serialize (SIZE bytes)
+     */
+    static BlockHeader deserialize(const uint8_t* in);
+
+    /**
+     * SHA-256 of the serialized header
+     */
+    Hash256 hash() const;
+
+    /**
+     * Commitment hash of a header: SHA-256 of the state root (sparse Merkle
+     * tree of the balances after the block) followed by the validator hash
+     * (SHA-256 of the address, zero for PoW)
+     */
+    static Hash256 commit(const Hash256& stateRoot, const Hash256& validatorHash);
+};
+
+// The nonce and the padding (at least 9 bytes) must fit in the second block
+static_assert(BlockHeader::NONCE_OFFSET >= 64 && BlockHeader::SIZE + 9 <= 128,
+              "the mining midstate needs a constant first SHA-256 block");
+
+#endif // BLOCK_HEADER_H
@@ -1,59 +1,349 @@
 #include "blockchain.h"
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <chrono>
+#include <thread>
 
 Blockchain::Blockchain(bool usePoS, int difficulty)
-    : difficulty(difficulty), totalStake(0), usePoS(usePoS), 
+    : totalStake(0), usePoS(usePoS), 
+      miningThreads(defaultWorkerThreads()), maxBlockTransactions(1000), shuttingDown(false), 
       rng(std::random_device()()) {
+    setDifficulty(difficulty);
     createGenesisBlock();
 }
 
 void Blockchain::createGenesisBlock() {
     // Create a genesis block with no transactions
     std::vector<Transaction> genesisTransactions;
-    Block genesisBlock(0, genesisTransactions, "0");
+    Block genesisBlock(0, genesisTransactions, Hash256::zero(), state.rootAfter(genesisTransactions));
     
     // If using PoS, validate the genesis block with a system validator
     if (usePoS) {
         genesisBlock.validateBlock("System");
     } else {
         // For PoW, we'll mine with minimal difficulty to speed things up
-        genesisBlock.mineBlock(1);
+        genesisBlock.mineBlock(Target::fromLeadingZeroNibbles(1).toCompact());
     }
     
     // Add the genesis block to the chain
     chain.push_back(genesisBlock);
+    state.apply(genesisTransactions);
+}
+
+Blockchain::~Blockchain() {
+    {
+        // Queued jobs are still run by the coordinator, cancelled, so every handle gets its outcome
+        std::lock_guard<std::mutex> lock(chainMutex);
+        shuttingDown = true;
+        for (const auto& job : pendingMining) {
+            job.cancelled->store(true);
+        }
+    }
+    miningQueued.notify_all();
+    if (miningCoordinator.joinable()) {
+        miningCoordinator.join();
+    }
 }
 
 Block Blockchain::getLatestBlock() const {
+    std::lock_guard<std::mutex> lock(chainMutex);
     return chain.back();
 }
 
 long Blockchain::addBlock(const std::vector<Transaction>& transactions) {
-    // Get the latest block
-    Block latestBlock = getLatestBlock();
-    int newIndex = latestBlock.getIndex() + 1;
+    if (!usePoS) {
+        // Mine on the background workers and wait for the outcome; if another
+        // block takes the tip first, mine the same transactions again on it
+        Block block = makeTemplate(transactions);
+        long totalTime = 0;
+        MiningOutcome outcome;
+        do {
+            outcome = startMining(block).wait();
+            totalTime += outcome.time;
+        } while (!outcome.appended);
+        return totalTime;
+    }
     
-    // Create a new block
-    Block newBlock(newIndex, transactions, latestBlock.getHash());
+    std::lock_guard<std::mutex> lock(chainMutex);
+    const Block& latestBlock = chain.back();
+    Block newBlock(latestBlock.getIndex() + 1, transactions, latestBlock.getHash(), state.rootAfter(transactions));
     
-    // Mine or validate the block based on consensus mechanism
-    long blockTime = 0;
-    if (usePoS) {
-        // Select a validator and validate the block
-        std::string validator = selectValidator();
-        blockTime = newBlock.validateBlock(validator);
-    } else {
-        // Mine the block with the current difficulty
-        blockTime = newBlock.mineBlock(difficulty);
-    }
+    // Select a validator and validate the block
+    std::string validator = selectValidator();
+    long blockTime = newBlock.validateBlock(validator);
     
     // Add the new block to the chain
-    chain.push_back(newBlock);
+    appendBlock(newBlock);
     return blockTime;
 }
 
+MiningHandle Blockchain::mineAsync(const std::vector<Transaction>& transactions) {
+    // The Merkle tree is built before taking the lock
+    return startMining(makeTemplate(transactions));
+}
+
+Block Blockchain::makeTemplate(const std::vector<Transaction>& transactions) {
+    // PoW blocks start with a coinbase transaction whose extra nonce the miners can roll
+    std::vector<Transaction> blockTransactions;
+    blockTransactions.reserve(transactions.size() + 1);
+    blockTransactions.push_back(Transaction::makeCoinbase("Miner", 0));
+    blockTransactions.insert(blockTransactions.end(), transactions.begin(), transactions.end());
+    return Block(0, blockTransactions, Hash256::zero());
+}
+
+MiningHandle Blockchain::startMining(Block block) {
+    std::shared_ptr<std::atomic<bool>> cancelled = std::make_shared<std::atomic<bool>>(false);
+    std::promise<MiningOutcome> promise;
+    MiningHandle handle(promise.get_future().share(), cancelled);
+    
+    std::lock_guard<std::mutex> lock(chainMutex);
+    const Block& latestBlock = chain.back();
+    block.rebase(latestBlock.getIndex() + 1, latestBlock.getHash(), state.rootAfter(block.getTransactions()));
+    
+    // Queue the block with the target for its height for the coordinator, started on first use
+    pendingMining.push_back(PendingMining{latestBlock.getHash(), cancelled});
+    miningQueue.push_back(MiningJob{block, bitsAt(chain.size()), getMiningPool(), cancelled, std::move(promise)});
+    if (!miningCoordinator.joinable()) {
+        miningCoordinator = std::thread(&Blockchain::coordinateMining, this);
+    }
+    miningQueued.notify_one();
+    return handle;
+}
+
+void Blockchain::addTransaction(const Transaction& transaction) {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    mempool.push_back(transaction);
+}
+
+size_t Blockchain::getPendingTransactionCount() const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    return mempool.size();
+}
+
+void Blockchain::setMaxBlockTransactions(size_t count) {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    maxBlockTransactions = count > 0 ? count : 1;
+}
+
+std::vector<Transaction> Blockchain::selectTransactions(size_t skip) const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    std::vector<Transaction> selected;
+    if (skip < mempool.size()) {
+        size_t count = std::min(maxBlockTransactions, mempool.size() - skip);
+        selected.assign(mempool.begin() + skip, mempool.begin() + skip + count);
+    }
+    return selected;
+}
+
+long Blockchain::produceBlocks(size_t count) {
+    long totalTime = 0;
+    Block current = makeTemplate(selectTransactions(0));
+    
+    for (size_t produced = 0; produced < count; ) {
+        // Transactions of the current template, taken from the front of the mempool
+        size_t taken = current.getTransactions().size() - 1;
+        MiningHandle handle = startMining(current);
+        
+        // Build the next template on this thread while the coordinator mines the current one
+        Block upcoming = makeTemplate(selectTransactions(taken));
+        
+        MiningOutcome outcome = handle.wait();
+        totalTime += outcome.time;
+        if (outcome.appended) {
+            {
+                std::lock_guard<std::mutex> lock(chainMutex);
+                mempool.erase(mempool.begin(), mempool.begin() + taken);
+            }
+            current = upcoming;
+            produced++;
+        } else {
+            // The next template assumed this block: rebuild it from the mempool
+            current = makeTemplate(selectTransactions(0));
+        }
+    }
+    return totalTime;
+}
+
+void Blockchain::coordinateMining() {
+    while (true) {
+        std::unique_lock<std::mutex> lock(chainMutex);
+        miningQueued.wait(lock, [this] { return shuttingDown || !miningQueue.empty(); });
+        if (miningQueue.empty()) {
+            return;
+        }
+        MiningJob job = std::move(miningQueue.front());
+        miningQueue.pop_front();
+        lock.unlock();
+        
+        // The pool runs one job at a time anyway: mining them in order loses nothing
+        runMining(job);
+    }
+}
+
+void Blockchain::runMining(MiningJob& job) {
+    Block& block = job.block;
+    const std::shared_ptr<std::atomic<bool>>& cancelled = job.cancelled;
+    long blockTime = block.mineBlock(job.bits, *job.pool, cancelled);
+    
+    MiningOutcome outcome;
+    outcome.index = block.getIndex();
+    outcome.time = blockTime;
+    {
+        std::lock_guard<std::mutex> lock(chainMutex);
+        
+        // A solution found after the tip or the target for its height changed is stale
+        outcome.appended = block.getMiningResult().found && !cancelled->load() && 
+                           chain.back().getHash() == block.getPreviousHash() &&
+                           block.getBits() == bitsAt(chain.size());
+        if (outcome.appended) {
+            appendBlock(block);
+            outcome.hash = block.getHash();
+        }
+        
+        MiningSample sample;
+        sample.blockIndex = block.getIndex();
+        sample.bits = job.bits;
+        sample.seconds = block.getMiningSeconds();
+        sample.hashesPerThread = block.getMiningResult().hashesPerThread;
+        sample.solved = outcome.appended;
+        telemetry.record(sample);
+        
+        for (size_t i = 0; i < pendingMining.size(); i++) {
+            if (pendingMining[i].cancelled == cancelled) {
+                pendingMining.erase(pendingMining.begin() + i);
+                break;
+            }
+        }
+    }
+    job.promise.set_value(outcome);
+}
+
+bool Blockchain::submitBlock(const Block& block) {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    if (!isBlockValid(block, chain.size(), state)) {
+        return false;
+    }
+    appendBlock(block);
+    return true;
+}
+
+void Blockchain::appendBlock(const Block& block) {
+    chain.push_back(block);
+    state.apply(block.getTransactions());
+    
+    // Jobs building on the previous tip can no longer produce a valid block
+    for (const auto& job : pendingMining) {
+        if (job.parent != block.getHash()) {
+            job.cancelled->store(true);
+        }
+    }
+}
+
+std::shared_ptr<MiningPool> Blockchain::getMiningPool() {
+    if (!miningPool || miningPool->size() != miningThreads) {
+        miningPool = std::make_shared<MiningPool>(miningThreads);
+    }
+    return miningPool;
+}
+
+void Blockchain::setDifficulty(int leadingZeros) {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    setFixedTarget(Target::fromLeadingZeroNibbles(leadingZeros).toCompact());
+}
+
+bool Blockchain::setTarget(uint32_t bits) {
+    if (!Target::isValidCompact(bits)) return false;
+    std::lock_guard<std::mutex> lock(chainMutex);
+    setFixedTarget(bits);
+    return true;
+}
+
+void Blockchain::enableRetargeting(uint32_t blockInterval, size_t window) {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    setRetargeter(std::make_shared<Retargeter>(blockInterval, window));
+}
+
+void Blockchain::disableRetargeting() {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    setRetargeter(nullptr);
+}
+
+bool Blockchain::isRetargeting() const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    return retargeterAt(chain.size()) != nullptr;
+}
+
+void Blockchain::setFixedTarget(uint32_t bits) {
+    // A second change before the next block replaces the first
+    if (!targetPeriods.empty() && targetPeriods.back().fromHeight == chain.size()) {
+        targetPeriods.pop_back();
+    }
+    targetPeriods.push_back(TargetPeriod{chain.size(), bits});
+}
+
+void Blockchain::setRetargeter(std::shared_ptr<const Retargeter> retargeter) {
+    // A second change before the next block replaces the first
+    if (!retargetPeriods.empty() && retargetPeriods.back().fromHeight == chain.size()) {
+        retargetPeriods.pop_back();
+    }
+    retargetPeriods.push_back(RetargetPeriod{chain.size(), retargeter});
+}
+
+uint32_t Blockchain::bitsAt(size_t height) const {
+    // With retargeting, the target follows the recent block times once the window is full
+    uint32_t bits = 0;
+    const Retargeter* retargeter = retargeterAt(height);
+    if (retargeter && retargeter->nextBits(chain, height, bits)) {
+        return bits;
+    }
+    for (size_t i = targetPeriods.size(); i > 0; i--) {
+        if (targetPeriods[i - 1].fromHeight <= height) {
+            return targetPeriods[i - 1].bits;
+        }
+    }
+    return targetPeriods.front().bits;
+}
+
+uint32_t Blockchain::getTargetBits() const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    return bitsAt(chain.size());
+}
+
+double Blockchain::getExpectedHashes() const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    return Target::fromCompact(bitsAt(chain.size())).expectedHashes();
+}
+
+const Retargeter* Blockchain::retargeterAt(size_t height) const {
+    for (size_t i = retargetPeriods.size(); i > 0; i--) {
+        if (retargetPeriods[i - 1].fromHeight <= height) {
+            return retargetPeriods[i - 1].retargeter.get();
+        }
+    }
+    return nullptr;
+}
+
+MiningTelemetry Blockchain::getMiningTelemetry() const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    return telemetry;
+}
+
+void Blockchain::resetMiningTelemetry() {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    telemetry.reset();
+}
+
+size_t Blockchain::getPendingMiningCount() const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    return pendingMining.size();
+}
+
+void Blockchain::setMiningThreads(unsigned threads) {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    miningThreads = threads > 0 ? threads : 1;
+}
+
 std::string Blockchain::selectValidator() const {
     // If there are no stakeholders, return a system validator
     if (stakeholders.empty()) {
@@ -77,37 +367,106 @@ std::string Blockchain::selectValidator() const {
 }
 
 void Blockchain::addStakeholder(const std::string& address, double stake) {
+    std::lock_guard<std::mutex> lock(chainMutex);
     stakeholders.push_back(Stakeholder(address, stake));
     totalStake += stake;
 }
 
 bool Blockchain::isChainValid() const {
-    // Check each block in the chain
+    std::lock_guard<std::mutex> lock(chainMutex);
+    
+    // Check each block in the chain against the balances replayed up to its parent
+    AccountState replayed;
+    replayed.apply(chain[0].getTransactions());
     for (size_t i = 1; i < chain.size(); i++) {
-        const Block& currentBlock = chain[i];
-        const Block& previousBlock = chain[i - 1];
-        
-        // Check if the block points to the correct previous block
-        if (currentBlock.getPreviousHash() != previousBlock.getHash()) {
-            std::cout << "Invalid previous hash in block " << i << std::endl;
-            return false;
-        }
-        
-        // Check if the block's hash is valid
-        if (currentBlock.getHash() != currentBlock.calculateHash()) {
-            std::cout << "Invalid hash in block " << i << std::endl;
+        if (!isBlockValid(chain[i], i, replayed)) {
             return false;
         }
+        replayed.apply(chain[i].getTransactions());
+    }
+    
+    return true;
+}
+
+Hash256 Blockchain::getStateRootAfter(const std::vector<Transaction>& transactions) const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    return state.rootAfter(transactions);
+}
+
+double Blockchain::getBalance(const std::string& address) const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    return state.getBalance(address);
+}
+
+double Blockchain::getBalance(const std::string& address, SparseMerkleProof& proof, Hash256& stateRoot) const {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    proof = state.getProof(address);
+    stateRoot = chain.back().getStateRoot();
+    return state.getBalance(address);
+}
+
+bool Blockchain::isBlockValid(const Block& currentBlock, size_t i, const AccountState& parentState) const {
+    const Block& previousBlock = chain[i - 1];
+    
+    // Check if the block sits at its position in the chain
+    if (currentBlock.getIndex() != previousBlock.getIndex() + 1) {
+        std::cout << "Invalid index in block " << i << std::endl;
+        return false;
+    }
+    
+    // Check if the block points to the correct previous block
+    if (currentBlock.getPreviousHash() != previousBlock.getHash()) {
+        std::cout << "Invalid previous hash in block " << i << std::endl;
+        return false;
+    }
+    
+    // Check if the block's hash is valid
+    if (currentBlock.getHash() != currentBlock.calculateHash()) {
+        std::cout << "Invalid hash in block " << i << std::endl;
+        return false;
+    }
+    
+    // Check if the header commits to the block's transactions
+    if (currentBlock.getMerkleRoot() != currentBlock.computeMerkleRoot()) {
+        std::cout << "Invalid Merkle root in block " << i << std::endl;
+        return false;
+    }
+    
+    // Check if the header commits to the balances its transactions give
+    if (currentBlock.getStateRoot() != parentState.rootAfter(currentBlock.getTransactions())) {
+        std::cout << "Invalid state root in block " << i << std::endl;
+        return false;
+    }
+    
+    // Mined blocks must meet the target committed in their header
+    if (currentBlock.getValidator().empty() && !currentBlock.meetsTarget()) {
+        std::cout << "Insufficient proof of work in block " << i << std::endl;
+        return false;
+    }
+    
+    // Mined blocks must use the target in force at their height (fixed or retargeted),
+    // not an easier one of their own choosing
+    if (currentBlock.getValidator().empty() && currentBlock.getBits() != bitsAt(i)) {
+        std::cout << "Unexpected target in block " << i << std::endl;
+        return false;
     }
     
     return true;
 }
 
 void Blockchain::printChain() const {
+    std::lock_guard<std::mutex> lock(chainMutex);
     std::cout << "===== Blockchain State =====" << std::endl;
     std::cout << "Consensus: " << (usePoS ? "Proof of Stake" : "Proof of Work") << std::endl;
     if (!usePoS) {
-        std::cout << "Difficulty: " << difficulty << std::endl;
+        uint32_t bits = bitsAt(chain.size());
+        std::cout << "Target: 0x" << std::hex << bits << std::dec 
+                  << " (~" << Target::fromCompact(bits).expectedHashes() << " hashes per block)" << std::endl;
+        const Retargeter* retargeter = retargeterAt(chain.size());
+        if (retargeter) {
+            std::cout << "Retargeting: " << retargeter->getBlockInterval() << " s per block over " 
+                      << retargeter->getWindow() << " blocks" << std::endl;
+        }
     } else {
         std::cout << "Stakeholders: " << stakeholders.size() << std::endl;
         std::cout << "Total Stake: " << totalStake << std::endl;
@@ -4,7 +4,19 @@
 #include <vector>
 #include <string>
 #include <random>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include "account_state.h"
 #include "block.h"
+#include "mining_pool.h"
+#include "mining_telemetry.h"
+#include "retarget.h"
 #include "transaction.h"
 
 // Structure to represent a stakeholder for PoS
@@ -16,16 +28,111 @@ struct Stakeholder {
         : address(address), stake(stake) {}
 };
 
+/**
+ * Outcome of a block mined in the background (see Blockchain::mineAsync)
+ */
+struct MiningOutcome {
+    bool appended;  // Whether the block was added to the chain
+    int index;      // Height the block was mined for
+    Hash256 hash;   // Hash of the block (meaningful only if appended)
+    long time;      // Mining time in milliseconds
+    
+    MiningOutcome() : appended(false), index(0), time(0) {}
+};
+
+/**
+ * Handle on a block being mined in the background
+ * 
+ * The block is appended as soon as it is solved. Mining stops early, without
+ * appending, when cancel() is called (e.g. because the caller's transaction set
+ * changed) or when another block extends the tip first.
+ */
+class MiningHandle {
+private:
+    std::shared_future<MiningOutcome> outcome;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+    
+public:
+    MiningHandle(std::shared_future<MiningOutcome> outcome, std::shared_ptr<std::atomic<bool>> cancelled)
+        : outcome(outcome), cancelled(cancelled) {}
+    
+    /**
+     * Ask the miners to give up (they stop after their current nonce chunk)
+     */
+    void cancel() { cancelled->store(true); }
+    
+    /**
+     * Check whether mining has finished, successfully or not
+     */
+    bool isReady() const { 
+        return outcome.wait_for(std::chrono::seconds(0)) == std::future_status::ready; 
+    }
+    
+    /**
+     * Wait for mining to finish
+     */
+    MiningOutcome wait() const { return outcome.get(); }
+    
+    /**
+     * Get the underlying future (e.g. to wait with a timeout)
+     */
+    std::shared_future<MiningOutcome> getFuture() const { return outcome; }
+};
+
 /**
  * Represents a blockchain with support for both PoW and PoS
+ * 
+ * PoW blocks are queued to one long-lived coordinator thread that hands them
+ * to the mining pool; the chain, the target and the telemetry are guarded by a
+ * mutex so transactions can be submitted meanwhile.
  */
 class Blockchain {
 private:
     std::vector<Block> chain;
-    int difficulty;                     // Mining difficulty for PoW
     std::vector<Stakeholder> stakeholders; // List of stakeholders for PoS
     double totalStake;                  // Total stake in the system
     bool usePoS;                        // Whether to use PoS (true) or PoW (false)
+    unsigned miningThreads;             // Number of threads used to mine a block
+    std::shared_ptr<MiningPool> miningPool; // Worker threads reused for every PoW block
+    
+    // Fixed compact PoW target in force from a given height on (setDifficulty/setTarget)
+    struct TargetPeriod {
+        size_t fromHeight;
+        uint32_t bits;
+    };
+    std::vector<TargetPeriod> targetPeriods; // Every change, by increasing height
+    
+    // Retargeting rule in force from a given height on (null retargeter: fixed target)
+    struct RetargetPeriod {
+        size_t fromHeight;
+        std::shared_ptr<const Retargeter> retargeter;
+    };
+    std::vector<RetargetPeriod> retargetPeriods; // Every enable/disable, by increasing height
+    MiningTelemetry telemetry;          // Statistics of the PoW blocks mined so far
+    AccountState state;                 // Balances after the tip (root committed in each header)
+    
+    // Background mining job, cancelled when the tip it builds on is replaced
+    struct PendingMining {
+        Hash256 parent;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+    std::vector<PendingMining> pendingMining; // Jobs not finished yet (queued or running)
+    
+    // Block template waiting for the mining coordinator
+    struct MiningJob {
+        Block block;
+        uint32_t bits;
+        std::shared_ptr<MiningPool> pool;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        std::promise<MiningOutcome> promise;
+    };
+    std::deque<MiningJob> miningQueue;  // Jobs not started yet, oldest first
+    std::deque<Transaction> mempool;    // Transactions waiting for produceBlocks, oldest first
+    size_t maxBlockTransactions;        // Transactions taken from the mempool per block
+    mutable std::mutex chainMutex;      // Guards the chain, state, target, telemetry, mempool and pending jobs
+    std::condition_variable miningQueued; // Signalled when a job is queued or on shutdown
+    bool shuttingDown;                  // Set by the destructor: the coordinator exits once the queue is empty
+    std::thread miningCoordinator;      // Long-lived thread running the queued jobs in order
     
     mutable std::mt19937 rng;           // Random number generator for PoS
     
@@ -34,22 +141,95 @@ private:
      */
     void createGenesisBlock();
     
+    /**
+     * Get the retargeting rule that applies to the block at the given height
+     * (null when the target was fixed; chainMutex held)
+     */
+    const Retargeter* retargeterAt(size_t height) const;
+    
+    /**
+     * Get the compact target a block mined at the given height must use: the
+     * retargeting rule's once its window is full, the fixed target otherwise
+     * (chainMutex held)
+     */
+    uint32_t bitsAt(size_t height) const;
+    
+    /**
+     * Start a fixed target period at the next height (chainMutex held)
+     */
+    void setFixedTarget(uint32_t bits);
+    
+    /**
+     * Start a retargeting period at the next height (chainMutex held)
+     */
+    void setRetargeter(std::shared_ptr<const Retargeter> retargeter);
+    
     /**
      * Select a validator based on stake (PoS)
      * 
      * @return Address of the selected validator
      */
     std::string selectValidator() const;
+    
+    /**
+     * Get the mining pool, starting its workers on first use
+     * (jobs keep a reference, so resizing never stops a running job)
+     */
+    std::shared_ptr<MiningPool> getMiningPool();
+    
+    /**
+     * Build a PoW block template (coinbase first) that is not attached to the chain yet
+     */
+    static Block makeTemplate(const std::vector<Transaction>& transactions);
+    
+    /**
+     * Copy up to maxBlockTransactions mempool transactions, skipping the first `skip`
+     */
+    std::vector<Transaction> selectTransactions(size_t skip) const;
+    
+    /**
+     * Rebase a template onto the current tip and mine it in the background
+     */
+    MiningHandle startMining(Block block);
+    
+    /**
+     * Check a block against the chain up to the given height (chainMutex held)
+     * 
+     * @param parentState Account state after the block at height - 1
+     */
+    bool isBlockValid(const Block& block, size_t height, const AccountState& parentState) const;
+    
+    /**
+     * Append a block, apply it to the state and cancel the jobs mining on the
+     * previous tip (chainMutex held)
+     */
+    void appendBlock(const Block& block);
+    
+    /**
+     * Main loop of the mining coordinator: run the queued jobs until shutdown
+     */
+    void coordinateMining();
+    
+    /**
+     * Mine one job, append the block if it still extends the tip and fulfil its handle
+     */
+    void runMining(MiningJob& job);
 
 public:
     /**
      * Constructor
      * 
      * @param usePoS Whether to use PoS (true) or PoW (false)
-     * @param difficulty Mining difficulty for PoW (ignored if usePoS is true)
+     * @param difficulty Mining difficulty for PoW as a number of leading zero hex digits
+     *                   (ignored if usePoS is true)
      */
     Blockchain(bool usePoS = false, int difficulty = 4);
     
+    /**
+     * Cancel the background mining jobs and stop the coordinator once they are done
+     */
+    ~Blockchain();
+    
     /**
      * Get the latest block in the chain
      */
@@ -58,11 +238,66 @@ public:
     /**
      * Add a new block with the given transactions
      * 
+     * With PoW this is mineAsync followed by a wait; if a competing block is
+     * submitted while it is being mined, the transactions are mined again on
+     * top of it, so the block is always added when this returns.
+     * 
      * @param transactions List of transactions to include in the block
      * @return Time taken to add the block in milliseconds
      */
     long addBlock(const std::vector<Transaction>& transactions);
     
+    /**
+     * Start mining a PoW block on top of the current tip and return immediately
+     * 
+     * The block is appended when solved, unless the handle was cancelled or the
+     * tip or the target changed in the meantime (the work is then counted as wasted).
+     * 
+     * @param transactions List of transactions to include in the block
+     * @return Handle to wait for or cancel the job
+     */
+    MiningHandle mineAsync(const std::vector<Transaction>& transactions);
+    
+    /**
+     * Queue a transaction for the blocks mined by produceBlocks
+     */
+    void addTransaction(const Transaction& transaction);
+    
+    /**
+     * Get the number of transactions waiting in the mempool
+     */
+    size_t getPendingTransactionCount() const;
+    
+    /**
+     * Set how many mempool transactions go into each produced block (at least one)
+     */
+    void setMaxBlockTransactions(size_t count);
+    
+    /**
+     * Mine PoW blocks from the mempool, pipelined
+     * 
+     * While block N is mined, the template of block N+1 (transaction selection,
+     * Merkle tree) is built on the calling thread, which would otherwise only
+     * wait for the coordinator; it is rebased onto N and mined as soon as N is
+     * appended. If N loses against a competing block, its transactions stay in
+     * the mempool and the next template is rebuilt.
+     * 
+     * @param count Number of blocks to append
+     * @return Total mining time in milliseconds
+     */
+    long produceBlocks(size_t count);
+    
+    /**
+     * Append a block produced elsewhere (e.g. a competing miner)
+     * 
+     * The block must extend the current tip and pass the checks of isChainValid:
+     * its Merkle root and its state root must be the ones its transactions give.
+     * Background jobs mining on the previous tip are cancelled.
+     * 
+     * @return false if the block was rejected
+     */
+    bool submitBlock(const Block& block);
+    
     /**
      * Add a stakeholder for PoS
      * 
@@ -74,12 +309,39 @@ public:
     /**
      * Verify the integrity of the blockchain
      * 
+     * The balances are replayed from the genesis block to check the state
+     * root of every header.
+     * 
      * @return true if the chain is valid, false otherwise
      */
     bool isChainValid() const;
     
+    /**
+     * Get the state root a block with these transactions must commit to on top
+     * of the tip (for blocks built elsewhere, see submitBlock)
+     */
+    Hash256 getStateRootAfter(const std::vector<Transaction>& transactions) const;
+    
+    /**
+     * Get the balance of an address at the tip (0 for unknown addresses)
+     */
+    double getBalance(const std::string& address) const;
+    
+    /**
+     * Get the balance of an address at the tip with its proof
+     * 
+     * AccountState::verifyBalance(address, balance, proof, stateRoot) then
+     * checks it without the chain; stateRoot is the one the tip's header commits
+     * to (BlockHeader::commit with the tip's validator hash).
+     * 
+     * @param proof Receives the proof of the balance (of absence for a zero balance)
+     * @param stateRoot Receives the state root of the tip
+     */
+    double getBalance(const std::string& address, SparseMerkleProof& proof, Hash256& stateRoot) const;
+    
     /**
      * Get the entire blockchain
+     * (not synchronized: do not call while a background job may append a block)
      */
     const std::vector<Block>& getChain() const { return chain; }
     
@@ -99,14 +361,82 @@ public:
     bool isUsingPoS() const { return usePoS; }
     
     /**
-     * Get the mining difficulty
+     * Get the compact PoW target the next block will be mined at
+     */
+    uint32_t getTargetBits() const;
+    
+    /**
+     * Get the expected number of hashes to mine the next block
+     */
+    double getExpectedHashes() const;
+    
+    /**
+     * Set the mining difficulty as a number of leading zero hex digits
+     * 
+     * Like setTarget, the target applies from the next block on: isChainValid
+     * checks every mined block against the target in force at its height.
+     */
+    void setDifficulty(int leadingZeros);
+    
+    /**
+     * Set the PoW target directly, for finer steps than whole hex digits
+     * 
+     * @param bits Compact target (see Target)
+     * @return false if bits is not a valid compact target (the target is unchanged)
+     */
+    bool setTarget(uint32_t bits);
+    
+    /**
+     * Adjust the target automatically to keep a steady block interval
+     * 
+     * Each new PoW block gets the mean target of the last `window` mined blocks,
+     * scaled by how far their timestamps drifted from the interval (see Retargeter).
+     * The configured target is used until the window is full, and isChainValid
+     * then checks every mined block against the target the rule gives.
+     * 
+     * The rule applies from the next block on: blocks already in the chain keep
+     * being checked against the rule (or fixed target) they were mined under.
+     * 
+     * @param blockInterval Desired time between blocks in seconds
+     * @param window Number of recent mined blocks to average over
+     */
+    void enableRetargeting(uint32_t blockInterval, size_t window = 10);
+    
+    /**
+     * Go back to the fixed target set by setDifficulty/setTarget, from the next block on
+     */
+    void disableRetargeting();
+    
+    /**
+     * Check if the target is adjusted automatically
+     */
+    bool isRetargeting() const;
+    
+    /**
+     * Get the number of mining threads
+     */
+    unsigned getMiningThreads() const { return miningThreads; }
+    
+    /**
+     * Set the number of mining threads (defaults to the hardware thread count)
+     * The worker pool is restarted with the new size on the next PoW block
+     */
+    void setMiningThreads(unsigned threads);
+    
+    /**
+     * Get the hash rate, time-to-solution and wasted-work statistics of the blocks mined so far
+     */
+    MiningTelemetry getMiningTelemetry() const;
+    
+    /**
+     * Forget the mining statistics (e.g. after a warm-up period)
      */
-    int getDifficulty() const { return difficulty; }
+    void resetMiningTelemetry();
     
     /**
-     * Set the mining difficulty
+     * Get the number of background mining jobs not finished yet (queued or running)
      */
-    void setDifficulty(int newDifficulty) { difficulty = newDifficulty; }
+    size_t getPendingMiningCount() const;
     
     /**
      * Switch between PoW and PoS
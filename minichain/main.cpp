@@ -76,11 +76,22 @@ void runBlockchainTest(bool usePoS, int difficulty, int blockCount, int txPerBlo
     // Verify blockchain integrity
     std::cout << "Blockchain is " << (blockchain.isChainValid() ? "valid" : "invalid") << "!" << std::endl;
     
+    // Answer a balance query with a proof against the tip's state root
+    SparseMerkleProof proof;
+    Hash256 stateRoot;
+    double balance = blockchain.getBalance("0xabc123", proof, stateRoot);
+    std::cout << "Balance of 0xabc123: " << balance << " (proof with " << proof.siblings.size() << " hashes, " 
+              << (AccountState::verifyBalance("0xabc123", balance, proof, stateRoot) ? "verified" : "rejected") 
+              << ")" << std::endl;
+    
     // Print performance statistics
     std::cout << "Performance Statistics:" << std::endl;
     std::cout << "Total Time: " << totalTime << " ms" << std::endl;
     std::cout << "Average Time per Block: " << static_cast<double>(totalTime) / blockCount << " ms" << std::endl;
     std::cout << "Average Time per Transaction: " << static_cast<double>(totalTime) / (blockCount * txPerBlock) << " ms" << std::endl;
+    if (!usePoS) {
+        std::cout << "Mining telemetry: " << blockchain.getMiningTelemetry().toJson() << std::endl;
+    }
     std::cout << std::endl;
 }
 
@@ -0,0 +1,166 @@
+#include "mining_pool.h"
+
+MiningPool::MiningPool(unsigned threads) : shuttingDown(false), nextJobId(0) {
+    if (threads == 0) threads = 1;
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&MiningPool::workerLoop, this, i);
+    }
+}
+
+MiningPool::~MiningPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shuttingDown = true;
+        // Make the current job's workers return quickly
+        for (const auto& job : jobs) {
+            job->stop.store(true);
+        }
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::future<MiningResult> MiningPool::submit(NonceSearch search, uint64_t firstNonce, uint64_t endNonce,
+                                             CancelFlag cancelled) {
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->search = std::move(search);
+    job->cancelled = std::move(cancelled);
+    job->stop.store(false);
+    job->solved.store(false);
+    job->winner.store(0);
+    job->finishedWorkers = 0;
+    job->hashesPerThread.assign(workers.size(), 0);
+
+    // Give every worker an equal contiguous slice of the range
+    uint64_t count = endNonce > firstNonce ? endNonce - firstNonce : 0;
+    uint64_t sliceSize = count / workers.size();
+    uint64_t begin = firstNonce;
+    for (size_t i = 0; i < workers.size(); i++) {
+        std::unique_ptr<Slice> slice(new Slice());
+        slice->begin = begin;
+        slice->end = (i + 1 == workers.size()) ? firstNonce + count : begin + sliceSize;
+        begin = slice->end;
+        job->slices.push_back(std::move(slice));
+    }
+
+    std::future<MiningResult> future = job->promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job->id = nextJobId++;
+        jobs.push_back(job);
+    }
+    jobAvailable.notify_all();
+    return future;
+}
+
+MiningResult MiningPool::mine(NonceSearch search, uint64_t firstNonce, uint64_t endNonce,
+                              CancelFlag cancelled) {
+    return submit(std::move(search), firstNonce, endNonce, std::move(cancelled)).get();
+}
+
+void MiningPool::workerLoop(unsigned workerId) {
+    uint64_t lastJobId = UINT64_MAX;
+
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            // Park until a job this worker has not processed yet is at the front
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [&] {
+                return shuttingDown || (!jobs.empty() && jobs.front()->id != lastJobId);
+            });
+            if (shuttingDown) return;
+            job = jobs.front();
+            lastJobId = job->id;
+        }
+
+        uint64_t count = 0;
+        uint64_t begin = 0;
+        uint64_t end = 0;
+        while (!job->stop.load(std::memory_order_relaxed) && 
+               !(job->cancelled && job->cancelled->load(std::memory_order_relaxed)) && 
+               claimChunk(*job, workerId, begin, end)) {
+            uint64_t nonce = 0;
+            if (job->search(begin, end, nonce, count)) {
+                // Only the first finder publishes its nonce
+                if (!job->solved.exchange(true)) {
+                    job->winner.store(nonce);
+                }
+                job->stop.store(true);
+            }
+        }
+        job->hashesPerThread[workerId] = count;
+
+        // The last worker to leave the job retires it and publishes the result
+        bool last = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++job->finishedWorkers == workers.size()) {
+                jobs.pop_front();
+                last = true;
+            }
+        }
+        if (last) {
+            MiningResult result;
+            result.found = job->solved.load();
+            result.nonce = job->winner.load();
+            result.hashesPerThread = job->hashesPerThread;
+            job->promise.set_value(result);
+            jobAvailable.notify_all();
+        }
+    }
+}
+
+bool MiningPool::claimChunk(Job& job, unsigned workerId, uint64_t& begin, uint64_t& end) {
+    do {
+        Slice& own = *job.slices[workerId];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.begin < own.end) {
+            begin = own.begin;
+            end = (own.end - own.begin > NONCE_CHUNK) ? own.begin + NONCE_CHUNK : own.end;
+            own.begin = end;
+            return true;
+        }
+    } while (steal(job, workerId));
+    return false;
+}
+
+bool MiningPool::steal(Job& job, unsigned workerId) {
+    // Pick the victim with the most nonces left
+    size_t victim = job.slices.size();
+    uint64_t largest = 0;
+    for (size_t i = 0; i < job.slices.size(); i++) {
+        if (i == workerId) continue;
+        Slice& slice = *job.slices[i];
+        std::lock_guard<std::mutex> lock(slice.mutex);
+        if (slice.end - slice.begin > largest) {
+            largest = slice.end - slice.begin;
+            victim = i;
+        }
+    }
+    if (victim == job.slices.size()) return false;
+
+    uint64_t stolenBegin = 0;
+    uint64_t stolenEnd = 0;
+    {
+        Slice& slice = *job.slices[victim];
+        std::lock_guard<std::mutex> lock(slice.mutex);
+        uint64_t remaining = slice.end - slice.begin;
+        if (remaining == 0) return true;  // Emptied meanwhile, look again
+        // Leave at least one chunk to the victim, take the upper half of the rest
+        uint64_t keep = remaining > 2 * NONCE_CHUNK ? remaining / 2 : (remaining > NONCE_CHUNK ? NONCE_CHUNK : remaining);
+        if (keep == remaining) return false;
+        stolenBegin = slice.begin + keep;
+        stolenEnd = slice.end;
+        slice.end = stolenBegin;
+    }
+
+    Slice& own = *job.slices[workerId];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    own.begin = stolenBegin;
+    own.end = stolenEnd;
+    return true;
+}
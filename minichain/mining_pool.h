@@ -0,0 +1,112 @@
+#ifndef MINING_POOL_H
+#define MINING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common/parallel_miner.h"
+
+/**
+ * Flag set by the owner of a job to abandon it (checked between nonce chunks)
+ */
+typedef std::shared_ptr<const std::atomic<bool>> CancelFlag;
+
+/**
+ * Long-lived pool of mining threads
+ *
+ * Workers are started once and parked on a condition variable between jobs.
+ * Each job (a block template to mine) is queued; its nonce range is split into
+ * one slice per worker, workers consume their slice in NONCE_CHUNK pieces and, once
+ * their own slice is empty, steal the upper half of the largest remaining one.
+ */
+class MiningPool {
+public:
+    /**
+     * Constructor
+     *
+     * @param threads Number of worker threads (at least one)
+     */
+    explicit MiningPool(unsigned threads);
+
+    /**
+     * Stop and join all workers (pending jobs are abandoned)
+     */
+    ~MiningPool();
+
+    MiningPool(const MiningPool&) = delete;
+    MiningPool& operator=(const MiningPool&) = delete;
+
+    /**
+     * Queue a job searching the nonce range [firstNonce, endNonce)
+     *
+     * @param cancelled Optional flag; once set, workers drop the job after their
+     *                  current chunk and the result reports found = false
+     * @return Future receiving the winning nonce and per-thread hash counts
+     */
+    std::future<MiningResult> submit(NonceSearch search, uint64_t firstNonce, uint64_t endNonce,
+                                     CancelFlag cancelled = CancelFlag());
+
+    /**
+     * Queue a job and wait for its result
+     */
+    MiningResult mine(NonceSearch search, uint64_t firstNonce, uint64_t endNonce,
+                      CancelFlag cancelled = CancelFlag());
+
+    /**
+     * Number of worker threads
+     */
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    // Nonces still to be tried by one worker: [begin, end)
+    struct Slice {
+        std::mutex mutex;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    struct Job {
+        uint64_t id;
+        NonceSearch search;
+        std::vector<std::unique_ptr<Slice>> slices;
+        std::vector<uint64_t> hashesPerThread;
+        std::atomic<bool> stop;        // Set when solved or when the pool shuts down
+        CancelFlag cancelled;          // Set by the submitter (may be null)
+        std::atomic<bool> solved;
+        std::atomic<uint64_t> winner;
+        unsigned finishedWorkers;      // Guarded by MiningPool::mutex
+        std::promise<MiningResult> promise;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<std::shared_ptr<Job>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    bool shuttingDown;
+    uint64_t nextJobId;
+
+    /**
+     * Main loop of a worker thread
+     */
+    void workerLoop(unsigned workerId);
+
+    /**
+     * Take the next chunk of nonces for a worker, stealing if its slice is empty
+     *
+     * @return false when the whole job range has been handed out
+     */
+    bool claimChunk(Job& job, unsigned workerId, uint64_t& begin, uint64_t& end);
+
+    /**
+     * Steal the upper half of the largest remaining slice into the worker's own slice
+     */
+    bool steal(Job& job, unsigned workerId);
+};
+
+#endif // MINING_POOL_H
@@ -0,0 +1,132 @@
+#include "mining_telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+void MiningTelemetry::record(const MiningSample& sample) {
+    samples.push_back(sample);
+}
+
+size_t MiningTelemetry::solvedCount() const {
+    size_t count = 0;
+    for (const auto& sample : samples) {
+        if (sample.solved) count++;
+    }
+    return count;
+}
+
+uint64_t MiningTelemetry::totalHashes() const {
+    uint64_t total = 0;
+    for (const auto& sample : samples) total += sample.totalHashes();
+    return total;
+}
+
+uint64_t MiningTelemetry::wastedHashes() const {
+    uint64_t total = 0;
+    for (const auto& sample : samples) {
+        if (!sample.solved) total += sample.totalHashes();
+    }
+    return total;
+}
+
+double MiningTelemetry::totalSeconds() const {
+    double total = 0;
+    for (const auto& sample : samples) total += sample.seconds;
+    return total;
+}
+
+double MiningTelemetry::hashRate() const {
+    double seconds = totalSeconds();
+    return seconds > 0 ? totalHashes() / seconds : 0;
+}
+
+std::vector<double> MiningTelemetry::hashRatePerThread() const {
+    // The thread count can change between blocks, so each worker slot is
+    // only timed over the samples it took part in
+    std::vector<double> hashes;
+    std::vector<double> seconds;
+    for (const auto& sample : samples) {
+        if (sample.hashesPerThread.size() > hashes.size()) {
+            hashes.resize(sample.hashesPerThread.size(), 0);
+            seconds.resize(sample.hashesPerThread.size(), 0);
+        }
+        for (size_t t = 0; t < sample.hashesPerThread.size(); t++) {
+            hashes[t] += sample.hashesPerThread[t];
+            seconds[t] += sample.seconds;
+        }
+    }
+
+    std::vector<double> rates(hashes.size(), 0);
+    for (size_t t = 0; t < hashes.size(); t++) {
+        if (seconds[t] > 0) rates[t] = hashes[t] / seconds[t];
+    }
+    return rates;
+}
+
+Distribution MiningTelemetry::timeToSolution() const {
+    std::vector<double> times;
+    for (const auto& sample : samples) {
+        if (sample.solved) times.push_back(sample.seconds);
+    }
+
+    Distribution distribution;
+    if (times.empty()) return distribution;
+
+    std::sort(times.begin(), times.end());
+    double sum = 0;
+    for (double time : times) sum += time;
+
+    // Nearest-rank percentiles
+    auto percentile = [&times](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * times.size()));
+        return times[std::max<size_t>(rank, 1) - 1];
+    };
+
+    distribution.count = times.size();
+    distribution.min = times.front();
+    distribution.mean = sum / times.size();
+    distribution.median = percentile(0.5);
+    distribution.p90 = percentile(0.9);
+    distribution.max = times.back();
+    return distribution;
+}
+
+std::string MiningTelemetry::toJson() const {
+    std::stringstream ss;
+    ss << std::setprecision(9);
+
+    Distribution tts = timeToSolution();
+    std::vector<double> perThread = hashRatePerThread();
+
+    ss << "{" << std::endl;
+    ss << "  \"templates\": " << samples.size() << "," << std::endl;
+    ss << "  \"solved\": " << solvedCount() << "," << std::endl;
+    ss << "  \"total_hashes\": " << totalHashes() << "," << std::endl;
+    ss << "  \"wasted_hashes\": " << wastedHashes() << "," << std::endl;
+    ss << "  \"seconds\": " << totalSeconds() << "," << std::endl;
+    ss << "  \"hashes_per_second\": " << hashRate() << "," << std::endl;
+    ss << "  \"hashes_per_second_per_thread\": [";
+    for (size_t t = 0; t < perThread.size(); t++) {
+        ss << (t ? ", " : "") << perThread[t];
+    }
+    ss << "]," << std::endl;
+    ss << "  \"time_to_solution\": {\"count\": " << tts.count << ", \"min\": " << tts.min
+       << ", \"mean\": " << tts.mean << ", \"median\": " << tts.median << ", \"p90\": " << tts.p90
+       << ", \"max\": " << tts.max << "}," << std::endl;
+    ss << "  \"samples\": [";
+    for (size_t i = 0; i < samples.size(); i++) {
+        const MiningSample& sample = samples[i];
+        ss << (i ? "," : "") << std::endl;
+        ss << "    {\"block\": " << sample.blockIndex << ", \"bits\": " << sample.bits
+           << ", \"solved\": " << (sample.solved ? "true" : "false") << ", \"seconds\": " << sample.seconds
+           << ", \"hashes\": " << sample.totalHashes() << ", \"hashes_per_thread\": [";
+        for (size_t t = 0; t < sample.hashesPerThread.size(); t++) {
+            ss << (t ? ", " : "") << sample.hashesPerThread[t];
+        }
+        ss << "]}";
+    }
+    ss << (samples.empty() ? "" : "\n  ") << "]" << std::endl;
+    ss << "}";
+    return ss.str();
+}
@@ -0,0 +1,112 @@
+#ifndef MINING_TELEMETRY_H
+#define MINING_TELEMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Outcome of one block template handed to the miners
+ */
+struct MiningSample {
+    int blockIndex;                        // Height of the block being mined
+    uint32_t bits;                         // Compact target it was mined for
+    double seconds;                        // Wall-clock time spent on the template
+    std::vector<uint64_t> hashesPerThread; // Attempts made by each worker
+    bool solved;                           // False if the template was abandoned (wasted work)
+
+    MiningSample() : blockIndex(0), bits(0), seconds(0), solved(false) {}
+
+    /**
+     * Total number of attempts across all workers
+     */
+    uint64_t totalHashes() const {
+        uint64_t total = 0;
+        for (uint64_t count : hashesPerThread) total += count;
+        return total;
+    }
+};
+
+/**
+ * Summary of a set of durations in seconds
+ */
+struct Distribution {
+    size_t count;
+    double min;
+    double mean;
+    double median;
+    double p90;
+    double max;
+
+    Distribution() : count(0), min(0), mean(0), median(0), p90(0), max(0) {}
+};
+
+/**
+ * Mining statistics accumulated over the templates mined by a blockchain
+ *
+ * Used to size miners (hash rate per thread and in aggregate) and to compare
+ * builds: toJson() gives a machine-readable dump of the summary and samples.
+ */
+class MiningTelemetry {
+public:
+    /**
+     * Add the outcome of one template
+     */
+    void record(const MiningSample& sample);
+
+    /**
+     * Forget all samples
+     */
+    void reset() { samples.clear(); }
+
+    /**
+     * Get every recorded sample, oldest first
+     */
+    const std::vector<MiningSample>& getSamples() const { return samples; }
+
+    /**
+     * Number of solved templates (mined blocks)
+     */
+    size_t solvedCount() const;
+
+    /**
+     * Attempts across all templates and workers
+     */
+    uint64_t totalHashes() const;
+
+    /**
+     * Attempts spent on templates that were abandoned before being solved
+     */
+    uint64_t wastedHashes() const;
+
+    /**
+     * Wall-clock time spent mining, in seconds
+     */
+    double totalSeconds() const;
+
+    /**
+     * Aggregate hash rate (hashes per second over all workers)
+     */
+    double hashRate() const;
+
+    /**
+     * Hash rate of each worker slot, over the samples where that worker ran
+     */
+    std::vector<double> hashRatePerThread() const;
+
+    /**
+     * Distribution of the time to solve a template (solved templates only)
+     */
+    Distribution timeToSolution() const;
+
+    /**
+     * Summary and samples as a JSON object
+     */
+    std::string toJson() const;
+
+private:
+    std::vector<MiningSample> samples;
+};
+
+#endif // MINING_TELEMETRY_H
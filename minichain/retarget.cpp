@@ -0,0 +1,37 @@
+#include "retarget.h"
+#include "../crypto/target.h"
+
+constexpr uint64_t Retargeter::MAX_ADJUSTMENT;
+
+Retargeter::Retargeter(uint32_t blockInterval, size_t window)
+    : blockInterval(blockInterval > 0 ? blockInterval : 1), window(window > 0 ? window : 1) {}
+
+bool Retargeter::nextBits(const std::vector<Block>& chain, size_t height, uint32_t& bits) const {
+    // Walk back over the last window + 1 mined blocks: window intervals, window targets
+    std::vector<const Block*> recent;
+    for (size_t i = height; i > 1 && recent.size() < window + 1; i--) {
+        const Block& block = chain[i - 1];
+        if (block.getValidator().empty()) {
+            recent.push_back(&block);
+        }
+    }
+    if (recent.size() < window + 1) return false;
+
+    std::vector<Target> targets;
+    for (size_t i = 0; i < window; i++) {
+        targets.push_back(Target::fromCompact(recent[i]->getBits()));
+    }
+
+    // Time the window took, bounded so one step never moves the target too far
+    const uint64_t expected = static_cast<uint64_t>(blockInterval) * window;
+    int64_t span = static_cast<int64_t>(recent.front()->getTimestamp()) -
+                   static_cast<int64_t>(recent.back()->getTimestamp());
+    uint64_t actual = span > 0 ? static_cast<uint64_t>(span) : 0;
+    if (actual < expected / MAX_ADJUSTMENT) actual = expected / MAX_ADJUSTMENT;
+    if (actual > expected * MAX_ADJUSTMENT) actual = expected * MAX_ADJUSTMENT;
+    if (actual == 0) actual = 1;
+
+    // Blocks too fast: smaller target (harder); too slow: larger target (easier)
+    bits = Target::mean(targets).scaled(actual, expected).toCompact();
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef RETARGET_H
+#define RETARGET_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "block.h"
+
+/**
+ * Difficulty retargeting over a sliding window of mined blocks
+ *
+ * The target of a new PoW block is the mean target of the last `window`
+ * mined blocks, scaled by how long they actually took compared to the
+ * configured block interval. Only header data (timestamps and targets) is
+ * used, so any node can recompute the expected target when validating.
+ * Timestamps have a one-second resolution, so intervals are in seconds.
+ */
+class Retargeter {
+public:
+    /**
+     * Largest factor by which the target moves in one step (either way)
+     */
+    static constexpr uint64_t MAX_ADJUSTMENT = 4;
+
+    /**
+     * Constructor
+     *
+     * @param blockInterval Desired time between blocks in seconds (at least 1)
+     * @param window Number of recent mined blocks to average over (at least 1)
+     */
+    Retargeter(uint32_t blockInterval, size_t window);
+
+    /**
+     * Compute the target of the PoW block at the given height
+     *
+     * The genesis block and PoS blocks are skipped. Until the window is
+     * full there is no rule and the chain's configured target applies.
+     *
+     * @param chain Blocks of the chain (only indices below height are read)
+     * @param height Index of the block whose target is wanted
+     * @param bits Receives the compact target
+     * @return false if there is not enough history yet
+     */
+    bool nextBits(const std::vector<Block>& chain, size_t height, uint32_t& bits) const;
+
+    /**
+     * Get the desired time between blocks in seconds
+     */
+    uint32_t getBlockInterval() const { return blockInterval; }
+
+    /**
+     * Get the number of blocks averaged over
+     */
+    size_t getWindow() const { return window; }
+
+private:
+    uint32_t blockInterval;
+    size_t window;
+};
+
+#endif // RETARGET_H
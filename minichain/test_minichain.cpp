@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include "blockchain.h"
+#include "../common/arena.h"
+
+// Display test results
+void displayTestResult(const std::string& testName, bool result) {
+    std::cout << "Test " << testName << ": " << (result ? "PASSED" : "FAILED") << std::endl;
+}
+
+// Slow blocks at the easiest target push the retargeted target past the
+// largest compact value: it must clamp there instead of encoding a zero target
+bool testRetargetSaturates() {
+    Blockchain blockchain(false, 0);
+    blockchain.setMiningThreads(1);
+    blockchain.enableRetargeting(1, 1);
+    std::vector<Transaction> transactions = { Transaction("tx1", "Alice", "Bob", 1) };
+    blockchain.addBlock(transactions);
+    // Twice the interval (timestamps have a one-second resolution)
+    std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+    blockchain.addBlock(transactions);
+    blockchain.addBlock(transactions);
+    return blockchain.getChain().size() == 4 && blockchain.getChain()[3].getBits() == Target::MAX_COMPACT &&
+           blockchain.isChainValid();
+}
+
+// Blocks mined at a fixed target before the rule is enabled (and after it is
+// disabled) are not checked against it; the blocks mined under it still are
+bool testRetargetEnabledMidChain() {
+    Blockchain blockchain(false, 1);
+    blockchain.setMiningThreads(1);
+    std::vector<Transaction> transactions = { Transaction("tx1", "Alice", "Bob", 1) };
+    for (int i = 0; i < 3; i++) {
+        blockchain.addBlock(transactions);
+    }
+    // Fast blocks for a long interval: the rule asks for harder targets than the fixed one
+    blockchain.enableRetargeting(60, 1);
+    blockchain.addBlock(transactions);
+    blockchain.addBlock(transactions);
+    bool validWhileRetargeting = blockchain.isChainValid();
+    blockchain.disableRetargeting();
+    blockchain.addBlock(transactions);
+    return validWhileRetargeting && !blockchain.isRetargeting() &&
+           blockchain.getChain().size() == 7 && blockchain.isChainValid();
+}
+
+// Retargeting must not overwrite the fixed target: once it is disabled, blocks
+// are mined at the target setDifficulty gave again
+bool testDisableRetargetingRestoresTarget() {
+    Blockchain blockchain(false, 1);
+    blockchain.setMiningThreads(1);
+    const uint32_t fixedBits = Target::fromLeadingZeroNibbles(1).toCompact();
+    std::vector<Transaction> transactions = { Transaction("tx1", "Alice", "Bob", 1) };
+    blockchain.enableRetargeting(60, 1);
+    for (int i = 0; i < 3; i++) {
+        blockchain.addBlock(transactions);
+    }
+    bool retargeted = blockchain.getChain().back().getBits() != fixedBits;
+    blockchain.disableRetargeting();
+    bool restored = blockchain.getTargetBits() == fixedBits;
+    blockchain.addBlock(transactions);
+    return retargeted && restored && blockchain.getChain().back().getBits() == fixedBits &&
+           blockchain.isChainValid();
+}
+
+// A competing block must use the chain's target: one mined at an easier target
+// (here the easiest one) is rejected, the same block at the chain's target is not
+bool testSubmitRejectsEasierTarget() {
+    Blockchain blockchain(false, 2);
+    blockchain.setMiningThreads(1);
+    std::vector<Transaction> theirs = { Transaction("theirs", "Carol", "Dave", 2) };
+    Block tip = blockchain.getLatestBlock();
+    Block easy(tip.getIndex() + 1, theirs, tip.getHash(), blockchain.getStateRootAfter(theirs));
+    easy.mineBlock(Target::MAX_COMPACT);
+    Block honest(tip.getIndex() + 1, theirs, tip.getHash(), blockchain.getStateRootAfter(theirs));
+    honest.mineBlock(blockchain.getTargetBits());
+    return easy.meetsTarget() && !blockchain.submitBlock(easy) && blockchain.getChain().size() == 1 &&
+           blockchain.submitBlock(honest) && blockchain.isChainValid();
+}
+
+// A competing block that takes the tip while addBlock mines must not make it
+// return without its block: the transactions are mined again on the new tip
+bool testAddBlockAfterCompetingBlock() {
+    Blockchain blockchain(false, 7);
+    blockchain.setMiningThreads(1);
+    std::vector<Transaction> ours = { Transaction("ours", "Alice", "Bob", 1) };
+    std::vector<Transaction> theirs = { Transaction("theirs", "Carol", "Dave", 2) };
+    std::thread miner([&blockchain, &ours]() { blockchain.addBlock(ours); });
+    // Wait until the job builds on the current tip: the competitor always cancels it
+    while (blockchain.getPendingMiningCount() == 0) {
+        std::this_thread::yield();
+    }
+    
+    // The retry mines at the easier target
+    blockchain.setDifficulty(1);
+    Block tip = blockchain.getLatestBlock();
+    Block competitor(tip.getIndex() + 1, theirs, tip.getHash(), blockchain.getStateRootAfter(theirs));
+    competitor.mineBlock(Target::fromLeadingZeroNibbles(1).toCompact());
+    bool submitted = blockchain.submitBlock(competitor);
+    miner.join();
+    
+    // Exactly one template was abandoned
+    MiningTelemetry telemetry = blockchain.getMiningTelemetry();
+    const std::vector<Block>& chain = blockchain.getChain();
+    return submitted && chain.size() == 3 && telemetry.getSamples().size() == telemetry.solvedCount() + 1 && chain[1].getTransactions()[0].getId() == "theirs" &&
+           chain[2].getTransactions()[1].getId() == "ours" && blockchain.isChainValid();
+}
+
+// Destroying the chain with one job mining and one queued cancels both, and
+// their handles still receive an outcome
+bool testShutdownWithQueuedJobs() {
+    std::vector<Transaction> transactions = { Transaction("tx1", "Alice", "Bob", 1) };
+    std::vector<MiningHandle> handles;
+    {
+        Blockchain blockchain(false, 7);
+        blockchain.setMiningThreads(1);
+        handles.push_back(blockchain.mineAsync(transactions));
+        handles.push_back(blockchain.mineAsync(transactions));
+    }
+    bool abandoned = true;
+    for (const auto& handle : handles) {
+        abandoned = abandoned && handle.isReady() && !handle.wait().appended;
+    }
+    return abandoned;
+}
+
+// Transaction ids of a mined block, without its coinbase
+std::vector<std::string> minedIds(const Block& block) {
+    std::vector<std::string> ids;
+    for (size_t i = 1; i < block.getTransactions().size(); i++) {
+        ids.push_back(block.getTransactions()[i].getId());
+    }
+    return ids;
+}
+
+// Blocks take the mempool transactions oldest first, maxBlockTransactions at a time
+bool testMempoolOrder() {
+    Blockchain blockchain(false, 1);
+    blockchain.setMiningThreads(1);
+    blockchain.setMaxBlockTransactions(2);
+    for (int i = 0; i < 5; i++) {
+        blockchain.addTransaction(Transaction("tx" + std::to_string(i), "Alice", "Bob", 1));
+    }
+    blockchain.produceBlocks(3);
+    
+    const std::vector<Block>& chain = blockchain.getChain();
+    return chain.size() == 4 && blockchain.getPendingTransactionCount() == 0 &&
+           minedIds(chain[1]) == std::vector<std::string>({ "tx0", "tx1" }) &&
+           minedIds(chain[2]) == std::vector<std::string>({ "tx2", "tx3" }) &&
+           minedIds(chain[3]) == std::vector<std::string>({ "tx4" }) && blockchain.isChainValid();
+}
+
+// When a competing block wins, the template built ahead (which skipped the lost
+// block's transactions) is dropped and the lost transactions are mined first
+bool testProduceAfterCompetingBlock() {
+    Blockchain blockchain(false, 7);
+    blockchain.setMiningThreads(1);
+    blockchain.setMaxBlockTransactions(2);
+    for (int i = 0; i < 4; i++) {
+        blockchain.addTransaction(Transaction("tx" + std::to_string(i), "Alice", "Bob", 1));
+    }
+    std::thread producer([&blockchain]() { blockchain.produceBlocks(2); });
+    // Wait until the job builds on the current tip: the competitor always cancels it
+    while (blockchain.getPendingMiningCount() == 0) {
+        std::this_thread::yield();
+    }
+    
+    blockchain.setDifficulty(1);
+    std::vector<Transaction> theirs = { Transaction("theirs", "Carol", "Dave", 2) };
+    Block tip = blockchain.getLatestBlock();
+    Block competitor(tip.getIndex() + 1, theirs, tip.getHash(), blockchain.getStateRootAfter(theirs));
+    competitor.mineBlock(Target::fromLeadingZeroNibbles(1).toCompact());
+    bool submitted = blockchain.submitBlock(competitor);
+    producer.join();
+    
+    MiningTelemetry telemetry = blockchain.getMiningTelemetry();
+    const std::vector<Block>& chain = blockchain.getChain();
+    return submitted && chain.size() == 4 && blockchain.getPendingTransactionCount() == 0 &&
+           telemetry.getSamples().size() == telemetry.solvedCount() + 1 &&
+           chain[1].getTransactions()[0].getId() == "theirs" &&
+           minedIds(chain[2]) == std::vector<std::string>({ "tx0", "tx1" }) &&
+           minedIds(chain[3]) == std::vector<std::string>({ "tx2", "tx3" }) && blockchain.isChainValid();
+}
+
+// An arena sized to the sum of its allocations serves them from one block;
+// larger requests get a block of their own and reset keeps only the first
+bool testArena() {
+    const size_t sizes[] = { 17, 1, 40, 6 };
+    MonotonicArena exact(64);
+    char* previous = nullptr;
+    bool contiguous = true;
+    for (size_t size : sizes) {
+        char* chunk = static_cast<char*>(exact.allocate(size, 1));
+        contiguous = contiguous && (previous == nullptr || chunk > previous);
+        std::fill(chunk, chunk + size, 'x');
+        previous = chunk;
+    }
+    bool oneBlock = contiguous && exact.getBlockCount() == 1;
+    
+    MonotonicArena small(16);
+    void* aligned = small.allocate(8, 8);
+    small.allocate(100);
+    bool ownBlock = small.getBlockCount() == 2 && reinterpret_cast<uintptr_t>(aligned) % 8 == 0;
+    small.reset();
+    return oneBlock && ownBlock && small.getBlockCount() == 1;
+}
+
+// rollExtraNonce recomputes the root from the cached branch and toString();
+// a tree rebuilt from serialize() must give the same root, whatever the amounts
+bool testRolledMerkleRoot() {
+    std::vector<Transaction> transactions = { Transaction::makeCoinbase("Miner", 0) };
+    const double amounts[] = { 1, 0.1, 1e-7, 123456789.5, -2.25, 1e21, -1.7976931348623157e308 };
+    for (size_t i = 0; i < sizeof(amounts) / sizeof(amounts[0]); i++) {
+        transactions.push_back(Transaction("tx" + std::to_string(i), "Alice", "Bob", amounts[i]));
+    }
+    
+    Block block(1, transactions, Hash256::zero());
+    bool ok = block.getMerkleRoot() == block.computeMerkleRoot();
+    for (int roll = 0; roll < 3; roll++) {
+        Hash256 before = block.getMerkleRoot();
+        ok = ok && block.rollExtraNonce() && block.getMerkleRoot() != before &&
+             block.getMerkleRoot() == block.computeMerkleRoot();
+    }
+    for (const auto& tx : block.getTransactions()) {
+        std::vector<char> text(tx.maxSerializedSize() + 1);
+        ok = ok && std::string(text.data(), tx.serialize(text.data(), text.size())) == tx.toString();
+    }
+    return ok && block.getExtraNonce() == 3;
+}
+
+int main() {
+    std::cout << "===== MINICHAIN TESTS =====" << std::endl << std::endl;
+
+    bool retargetSaturates = testRetargetSaturates();
+    bool retargetMidChain = testRetargetEnabledMidChain();
+    bool retargetDisabled = testDisableRetargetingRestoresTarget();
+    bool easierTarget = testSubmitRejectsEasierTarget();
+    bool competingBlock = testAddBlockAfterCompetingBlock();
+    bool shutdown = testShutdownWithQueuedJobs();
+    bool mempoolOrder = testMempoolOrder();
+    bool produceCompeting = testProduceAfterCompetingBlock();
+    bool arena = testArena();
+    bool rolledRoot = testRolledMerkleRoot();
+    std::cout << std::endl;
+    displayTestResult("Retarget saturates", retargetSaturates);
+    displayTestResult("Retarget enabled mid-chain", retargetMidChain);
+    displayTestResult("Disable retargeting restores target", retargetDisabled);
+    displayTestResult("Submit rejects easier target", easierTarget);
+    displayTestResult("Add block after competing block", competingBlock);
+    displayTestResult("Shutdown with queued jobs", shutdown);
+    displayTestResult("Mempool order", mempoolOrder);
+    displayTestResult("Produce after competing block", produceCompeting);
+    displayTestResult("Arena", arena);
+    displayTestResult("Rolled Merkle root", rolledRoot);
+
+    bool allPassed = retargetSaturates && retargetMidChain && retargetDisabled && easierTarget &&
+                     competingBlock && shutdown && mempoolOrder && produceCompeting && arena && rolledRoot;
+    std::cout << std::endl << (allPassed ? "All tests passed!" : "Some tests failed!") << std::endl;
+    return allPassed ? 0 : 1;
+}
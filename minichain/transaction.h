@@ -1,6 +1,8 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
+#include <cstdint>
+#include <cstdio>
 #include <string>
 #include <sstream>
 
@@ -13,6 +15,10 @@ private:
     std::string sender;
     std::string receiver;
     double amount;
+    bool coinbase;               // First transaction of a mined block
+    uint64_t extraNonce;         // Rolled by the miner once the header nonce space is exhausted
+
+    static const size_t MAX_AMOUNT_LENGTH = 16; // Longest %g output, e.g. "-1.79769e+308"
 
 public:
     /**
@@ -25,7 +31,26 @@ public:
      */
     Transaction(const std::string& id, const std::string& sender, 
                 const std::string& receiver, double amount)
-        : id(id), sender(sender), receiver(receiver), amount(amount) {}
+        : id(id), sender(sender), receiver(receiver), amount(amount), 
+          coinbase(false), extraNonce(0) {}
+    
+    /**
+     * Create the coinbase transaction placed first in a PoW block
+     * 
+     * The extra nonce is part of the transaction ID, so changing it changes the
+     * first Merkle leaf and gives the miners a fresh header nonce space
+     * 
+     * @param miner Address of the miner
+     * @param extraNonce Extra nonce committed in the Merkle root
+     */
+    static Transaction makeCoinbase(const std::string& miner, uint64_t extraNonce) {
+        std::stringstream id;
+        id << "coinbase/" << extraNonce;
+        Transaction tx(id.str(), "", miner, 0);
+        tx.coinbase = true;
+        tx.extraNonce = extraNonce;
+        return tx;
+    }
     
     /**
      * Get transaction ID
@@ -47,6 +72,38 @@ public:
      */
     double getAmount() const { return amount; }
     
+    /**
+     * Check whether this is a coinbase transaction
+     */
+    bool isCoinbase() const { return coinbase; }
+    
+    /**
+     * Get the extra nonce (coinbase only)
+     */
+    uint64_t getExtraNonce() const { return extraNonce; }
+    
+    /**
+     * Upper bound on the length of toString(), from the field sizes alone
+     * (the amount takes at most MAX_AMOUNT_LENGTH characters as %g)
+     */
+    size_t maxSerializedSize() const {
+        return id.size() + sender.size() + receiver.size() + 3 + MAX_AMOUNT_LENGTH;
+    }
+    
+    /**
+     * Write toString() into out (used to serialize a whole block into one
+     * arena instead of one string per transaction)
+     * 
+     * @param out Buffer of at least maxSerializedSize() + 1 bytes
+     * @param capacity Size of out
+     * @return Number of bytes written, not counting the terminating zero
+     */
+    size_t serialize(char* out, size_t capacity) const {
+        int length = std::snprintf(out, capacity, "%s:%s:%s:%g", 
+                                   id.c_str(), sender.c_str(), receiver.c_str(), amount);
+        return static_cast<size_t>(length) < capacity ? static_cast<size_t>(length) : capacity - 1;
+    }
+    
     /**
      * Convert transaction to a string for hashing
      */
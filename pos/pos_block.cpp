@@ -1,34 +1,32 @@
 #include "pos_block.h"
 #include <sstream>
 #include <iomanip>
-#include <openssl/sha.h>
+#include "../crypto/sha256.h"
+#include "../common/serialize.h"
 
-// Helper function to calculate SHA-256 hash
-inline std::string sha256(const std::string& str) {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, str.c_str(), str.size());
-    SHA256_Final(hash, &sha256);
-    
-    std::stringstream ss;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i];
-    }
-    return ss.str();
-}
+constexpr size_t PosBlock::HEADER_SIZE;
 
 // Constructor for PosBlock
-PosBlock::PosBlock(int idx, const std::string& data, const std::string& prevHash, const std::string& validator) 
-    : index(idx), timestamp(std::time(nullptr)), data(data), previousHash(prevHash), validator(validator) {
+PosBlock::PosBlock(int idx, const std::string& data, const Hash256& prevHash, const std::string& validator) 
+    : index(idx), timestamp(std::time(nullptr)), data(data), dataHash(sha256(data)), 
+      previousHash(prevHash), validator(validator), validatorHash(sha256(validator)) {
     hash = calculateHash();
 }
 
-// Calculate the hash of the block
-std::string PosBlock::calculateHash() const {
-    std::stringstream ss;
-    ss << index << timestamp << data << previousHash << validator;
-    return sha256(ss.str());
+// Serialize the header; data and validator are committed through their hashes
+void PosBlock::serializeHeader(uint8_t* out) const {
+    uint8_t* p = writeLE32(out, static_cast<uint32_t>(index));
+    p = writeLE32(p, static_cast<uint32_t>(timestamp));
+    p = writeHash(p, previousHash);
+    p = writeHash(p, dataHash);
+    writeHash(p, validatorHash);
+}
+
+// Calculate the hash of the block from its binary header
+Hash256 PosBlock::calculateHash() const {
+    uint8_t header[HEADER_SIZE];
+    serializeHeader(header);
+    return sha256(header, HEADER_SIZE);
 }
 
 // String representation of the block
@@ -5,28 +5,39 @@
 #include <ctime>
 #include <vector>
 #include <sstream>
+#include <cstdint>
+#include "../crypto/hash256.h"
 
 class PosBlock {
 private:
     int index;                      // Position of the block in the chain
     time_t timestamp;               // Timestamp of when the block was created
     std::string data;               // Data stored in the block
-    std::string previousHash;       // Hash of the previous block
-    std::string hash;               // Hash of the current block
+    Hash256 dataHash;               // Hash of the data, committed in the header
+    Hash256 previousHash;           // Hash of the previous block
+    Hash256 hash;                   // Hash of the current block
     std::string validator;          // Address of the validator who created this block
+    Hash256 validatorHash;          // Hash of the validator address, committed in the header
     
 public:
+    // Binary header (little-endian integers, raw 32-byte hashes):
+    //   index (4) | timestamp (4) | previous hash (32) | data hash (32) | validator hash (32)
+    static constexpr size_t HEADER_SIZE = 104;
+
     // Constructor
-    PosBlock(int idx, const std::string& data, const std::string& prevHash, const std::string& validator);
+    PosBlock(int idx, const std::string& data, const Hash256& prevHash, const std::string& validator);
+    
+    // Write the binary header into out (HEADER_SIZE bytes)
+    void serializeHeader(uint8_t* out) const;
     
     // Calculate the hash of the block
-    std::string calculateHash() const;
+    Hash256 calculateHash() const;
     
     // Getters
     int getIndex() const { return index; }
     std::string getData() const { return data; }
-    std::string getHash() const { return hash; }
-    std::string getPreviousHash() const { return previousHash; }
+    Hash256 getHash() const { return hash; }
+    Hash256 getPreviousHash() const { return previousHash; }
     time_t getTimestamp() const { return timestamp; }
     std::string getValidator() const { return validator; }
     
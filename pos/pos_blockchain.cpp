@@ -10,7 +10,7 @@ PosBlockchain::PosBlockchain() {
     rng.seed(rd());
     
     // Create genesis block
-    chain.emplace_back(PosBlock(0, "Genesis Block", "0", "System"));
+    chain.emplace_back(PosBlock(0, "Genesis Block", Hash256::zero(), "System"));
 }
 
 // Add a stakeholder to the network
@@ -2,50 +2,72 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
-#include <openssl/sha.h>
 #include <chrono>
+#include <limits>
+#include "../crypto/sha256_mb.h"
+#include "../common/serialize.h"
 
-// Fonction pour calculer le hash SHA-256 d'une chaîne de caractères
-inline std::string sha256(const std::string& str) {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, str.c_str(), str.size());
-    SHA256_Final(hash, &sha256);
-    
-    std::stringstream ss;
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i];
-    }
-    return ss.str();
-}
+constexpr size_t Block::HEADER_SIZE;
+constexpr size_t Block::NONCE_OFFSET;
 
 // Constructeur de Block
-Block::Block(int idx, const std::string& data, const std::string& prevHash) 
-    : index(idx), timestamp(std::time(nullptr)), data(data), previousHash(prevHash), nonce(0) {
+Block::Block(int idx, const std::string& data, const Hash256& prevHash) 
+    : index(idx), timestamp(std::time(nullptr)), data(data), dataHash(sha256(data)), 
+      previousHash(prevHash), bits(0), nonce(0) {
     hash = calculateHash();
 }
 
-// Calculer le hash du bloc en utilisant ses attributs
-std::string Block::calculateHash() const {
-    std::stringstream ss;
-    ss << index << timestamp << data << previousHash << nonce;
-    return sha256(ss.str());
+// Sérialiser l'en-tête ; les données sont engagées par leur hash pour garder une taille fixe
+void Block::serializeHeader(uint8_t* out) const {
+    uint8_t* p = writeLE32(out, static_cast<uint32_t>(index));
+    p = writeLE32(p, static_cast<uint32_t>(timestamp));
+    p = writeHash(p, previousHash);
+    p = writeHash(p, dataHash);
+    p = writeLE32(p, bits);
+    writeLE64(p, nonce);
 }
 
-// Miner le bloc avec une difficulté donnée
-void Block::mineBlock(int difficulty) {
-    // Créer une chaîne de caractères qui servira de "cible" pour le PoW
-    // Par exemple, difficulty = 4 signifie que le hash doit commencer par "0000"
-    std::string target(difficulty, '0');
+// Calculer le hash du bloc à partir de son en-tête binaire
+Hash256 Block::calculateHash() const {
+    uint8_t header[HEADER_SIZE];
+    serializeHeader(header);
+    return sha256(header, HEADER_SIZE);
+}
+
+// Miner le bloc pour une cible compacte donnée, réparti sur plusieurs threads
+MiningResult Block::mineBlock(uint32_t targetBits, unsigned threads) {
+    // Le hash, lu comme un entier de 256 bits, doit être inférieur ou égal à la cible
+    // La cible fait partie de l'en-tête : elle est fixée avant de sérialiser le préfixe
+    bits = targetBits;
+    const Target target = Target::fromCompact(bits);
+    
+    // Le préfixe (tout l'en-tête sauf le nonce) est sérialisé une seule fois
+    uint8_t header[HEADER_SIZE];
+    serializeHeader(header);
     
-    // Continuer à incrémenter le nonce jusqu'à ce que le hash commence par la cible
-    while (hash.substr(0, difficulty) != target) {
-        nonce++;
+    // Le premier bloc SHA-256 de l'en-tête est absorbé une seule fois,
+    // puis les nonces sont hachés par lots sur plusieurs voies SIMD
+    const sha256mb::NonceHasher hasher(std::string(reinterpret_cast<const char*>(header), NONCE_OFFSET));
+    auto search = [&hasher, &target](uint64_t begin, uint64_t end, uint64_t& found, uint64_t& tried) {
+        return hasher.search(begin, end, [&target](const Hash256& digest) {
+            return target.isMetBy(digest);
+        }, found, tried);
+    };
+    
+    // Chaque thread parcourt sa part des nonces ; le premier nonce valide arrête les autres
+    MiningResult result = mineParallel(threads, nonce, std::numeric_limits<uint64_t>::max(), search);
+    if (result.found) {
+        nonce = result.nonce;
         hash = calculateHash();
     }
     
     std::cout << "Bloc miné ! Hash: " << hash << std::endl;
+    return result;
+}
+
+// Vérifier que le hash respecte la cible inscrite dans l'en-tête
+bool Block::meetsTarget() const {
+    return Target::isValidCompact(bits) && Target::fromCompact(bits).isMetBy(hash);
 }
 
 // Affichage du bloc sous forme de chaîne de caractères
@@ -56,6 +78,7 @@ std::string Block::toString() const {
     ss << "  Data: " << data << std::endl;
     ss << "  Previous Hash: " << previousHash << std::endl;
     ss << "  Hash: " << hash << std::endl;
+    ss << "  Bits: 0x" << std::hex << bits << std::dec << std::endl;
     ss << "  Nonce: " << nonce << std::endl;
     ss << "]" << std::endl;
     return ss.str();
@@ -6,36 +6,52 @@
 #include <vector>
 #include <sstream>
 #include <iomanip>
-
-// Déclaration anticipée de la fonction SHA-256
-std::string sha256(const std::string& str);
+#include "../crypto/hash256.h"
+#include "../crypto/sha256.h"
+#include "../crypto/target.h"
+#include "../common/parallel_miner.h"
 
 class Block {
 private:
     int index;                      // Position du bloc dans la chaîne
     time_t timestamp;               // Timestamp de création du bloc
     std::string data;               // Données stockées dans le bloc
-    std::string previousHash;       // Hash du bloc précédent
-    std::string hash;               // Hash du bloc actuel
-    int nonce;                      // Nonce utilisé pour le PoW
+    Hash256 dataHash;               // Hash des données, engagé dans l'en-tête
+    Hash256 previousHash;           // Hash du bloc précédent
+    Hash256 hash;                   // Hash du bloc actuel
+    uint32_t bits;                  // Cible compacte du PoW (0 si le bloc n'est pas miné)
+    uint64_t nonce;                 // Nonce utilisé pour le PoW
     
 public:
+    // En-tête binaire (entiers little-endian, hashs bruts de 32 octets) :
+    //   index (4) | timestamp (4) | hash précédent (32) | hash des données (32) | bits (4) | nonce (8)
+    // Le nonce est à la fin : les 64 premiers octets ne changent pas pendant le minage
+    static constexpr size_t HEADER_SIZE = 84;
+    static constexpr size_t NONCE_OFFSET = 76;
+
     // Constructeur
-    Block(int idx, const std::string& data, const std::string& prevHash);
+    Block(int idx, const std::string& data, const Hash256& prevHash);
+    
+    // Écrire l'en-tête binaire dans out (HEADER_SIZE octets)
+    void serializeHeader(uint8_t* out) const;
     
     // Calculer le hash du bloc
-    std::string calculateHash() const;
+    Hash256 calculateHash() const;
+    
+    // Miner le bloc pour une cible compacte donnée, réparti sur plusieurs threads
+    MiningResult mineBlock(uint32_t targetBits, unsigned threads = 1);
     
-    // Miner le bloc avec une difficulté donnée
-    void mineBlock(int difficulty);
+    // Vérifier que le hash respecte la cible inscrite dans l'en-tête
+    bool meetsTarget() const;
     
     // Getters
     int getIndex() const { return index; }
     std::string getData() const { return data; }
-    std::string getHash() const { return hash; }
-    std::string getPreviousHash() const { return previousHash; }
+    Hash256 getHash() const { return hash; }
+    Hash256 getPreviousHash() const { return previousHash; }
     time_t getTimestamp() const { return timestamp; }
-    int getNonce() const { return nonce; }
+    uint64_t getNonce() const { return nonce; }
+    uint32_t getBits() const { return bits; }
     
     // Pour afficher le bloc
     std::string toString() const;
@@ -3,9 +3,11 @@
 #include <chrono>
 
 // Constructeur de Blockchain
-Blockchain::Blockchain(int difficulty) : difficulty(difficulty) {
+Blockchain::Blockchain(int difficulty) : miningThreads(defaultWorkerThreads()) {
+    setDifficulty(difficulty);
+    
     // Créer le bloc genesis
-    chain.emplace_back(Block(0, "Genesis Block", "0"));
+    chain.emplace_back(Block(0, "Genesis Block", Hash256::zero()));
 }
 
 // Ajouter un nouveau bloc à la blockchain
@@ -19,7 +21,7 @@ void Blockchain::addBlock(const std::string& data) {
     // Miner le nouveau bloc
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    newBlock.mineBlock(difficulty);
+    newBlock.mineBlock(targetBits, miningThreads);
     
     auto endTime = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
@@ -46,6 +48,12 @@ bool Blockchain::isChainValid() const {
             return false;
         }
         
+        // Vérifier que le hash respecte la cible inscrite dans l'en-tête
+        if (!currentBlock.meetsTarget()) {
+            std::cout << "Preuve de travail insuffisante pour le bloc #" << i << std::endl;
+            return false;
+        }
+        
         // Vérifier que le bloc pointe bien vers le précédent
         if (currentBlock.getPreviousHash() != previousBlock.getHash()) {
             std::cout << "Lien cassé entre les blocs #" << (i-1) << " et #" << i << std::endl;
@@ -56,6 +64,13 @@ bool Blockchain::isChainValid() const {
     return true;
 }
 
+// Fixer directement la cible compacte
+bool Blockchain::setTarget(uint32_t bits) {
+    if (!Target::isValidCompact(bits)) return false;
+    targetBits = bits;
+    return true;
+}
+
 // Obtenir le dernier bloc de la chaîne
 const Block& Blockchain::getLatestBlock() const {
     return chain.back();
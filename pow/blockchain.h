@@ -7,10 +7,11 @@
 class Blockchain {
 private:
     std::vector<Block> chain;
-    int difficulty;  // Difficulté pour le PoW
+    uint32_t targetBits;  // Cible compacte du PoW pour les nouveaux blocs
+    unsigned miningThreads;  // Nombre de threads de minage
     
 public:
-    // Constructeur
+    // Constructeur (difficulté = nombre de chiffres hexadécimaux nuls en tête)
     Blockchain(int difficulty = 4);
     
     // Ajouter un nouveau bloc à la chaîne
@@ -25,11 +26,21 @@ public:
     // Obtenir tous les blocs
     const std::vector<Block>& getChain() const { return chain; }
     
-    // Changer la difficulté
-    void setDifficulty(int newDifficulty) { difficulty = newDifficulty; }
+    // Changer la difficulté (nombre de chiffres hexadécimaux nuls en tête)
+    void setDifficulty(int newDifficulty) { targetBits = Target::fromLeadingZeroNibbles(newDifficulty).toCompact(); }
     
-    // Obtenir la difficulté actuelle
-    int getDifficulty() const { return difficulty; }
+    // Fixer directement la cible compacte, par pas plus fins qu'un chiffre hexadécimal
+    // Retourne false si la cible n'est pas valide (elle reste alors inchangée)
+    bool setTarget(uint32_t bits);
+    
+    // Obtenir la cible compacte actuelle
+    uint32_t getTargetBits() const { return targetBits; }
+    
+    // Changer le nombre de threads de minage
+    void setMiningThreads(unsigned threads) { miningThreads = threads > 0 ? threads : 1; }
+    
+    // Obtenir le nombre de threads de minage
+    unsigned getMiningThreads() const { return miningThreads; }
 };
 
 #endif // BLOCKCHAIN_H
\ No newline at end of file